@@ -0,0 +1,151 @@
+#include "AdcSampler.h"
+#include "WindDir.h"
+#include <math.h>
+
+/***********************************************************************************************
+* AdcSampler.cpp: AdcSampler class: the wind vane and supply voltage, read by the continuous   *
+*                 (DMA) ADC (ADC_DMA) or one conversion at a time (ADC_ONESHOT)                *
+*                                                                                              *
+* Version: 0.1                                                                                 *
+* Last updated: 17/10/2026                                                                     *
+* Author: Jim Gunther                                                                          *
+*                                                                                              *
+* ADC_DMA: the ADC converts both pins at ADC_HZ into DMA frames on its own, and each frame's   *
+* ADC_OVERSAMPLE conversions per pin are averaged into one reading when poll() collects it.    *
+* A frame lasts LOOP_TIME (20 kHz is the ESP32's slowest rate, so a frame is 10000 bytes: the  *
+* driver chains DMA descriptors for frames over 4092 bytes from IDF 5.1), so poll() once a     *
+* loop finds one frame ready; it takes every ready frame, so a late loop loses none of the     *
+* ADC_MAX_FRAMES the driver keeps. ADC_ONESHOT: one conversion per pin each poll(). Either     *
+* way a reading is raw counts (avg_read_raw or analogRead(), as before the continuous ADC),    *
+* put through VANE_CAL or VOLTS_CAL: the core's eFuse millivolts stop at the attenuation's     *
+* top (about 3.1 V), short of the 3.3 V the vane spans. The vane's readings are averaged as    *
+* unit vectors (WindDir's table), so north (where the counts wrap) averages to north, and      *
+* atan2f turns them back into counts once a second in takeVane(); a vane jittering across the  *
+* join within one frame averages to the wrong side: WD_OFFSET can put the join where the wind  *
+* seldom comes from.                                                                           *
+***********************************************************************************************/
+
+static const calPoint vaneCal[] = VANE_CAL;
+static const calPoint voltsCal[] = VOLTS_CAL;
+#define NUM_CAL(c) ((int)(sizeof(c) / sizeof(c[0])))
+
+/**************************************************************************************************
+calibrate(): raw counts through a calibration curve (straight between its points, and carried on
+             from the end segments outside them)
+parameters: raw: int: raw counts, cal: const calPoint*: the curve, n: int: its points
+returns: float: counts
+***************************************************************************************************/
+static float calibrate(int raw, const calPoint* cal, int n) {
+  float x = (float)raw;
+  int i = 1;
+  while ((i < n - 1) && (x > cal[i].in)) i++;
+  float span = cal[i].in - cal[i - 1].in;
+  if (span <= 0.0f) return cal[i].out;
+  return cal[i - 1].out + (x - cal[i - 1].in) * (cal[i].out - cal[i - 1].out) / span;
+}
+
+AdcSampler::AdcSampler() {
+  _vane = _volts = 0.0f;
+  _vSin = _vCos = 0.0f;
+  _vN = 0;
+  _voltsSum = 0.0f;
+  _voltsN = 0;
+  _dma = false;
+};
+
+/**************************************************************************************************
+begin(): starts the continuous ADC (ADC_DMA), falling back to one-shot reads if it will not start,
+         and takes a first reading
+parameters: none
+returns: bool: true if the ADC_BACKEND asked for is running
+***************************************************************************************************/
+bool AdcSampler::begin() {
+  bool ok = true;
+#if ADC_BACKEND == ADC_DMA
+  const uint8_t pins[] = { WDPin, VoltsPin };
+  _dma = analogContinuous(pins, 2, ADC_OVERSAMPLE, ADC_HZ, NULL) && analogContinuousStart();
+  if (!_dma) {
+    analogContinuousDeinit();
+    ok = false;
+  }
+#endif
+  if (!_dma) {
+    add(analogRead(WDPin), analogRead(VoltsPin));
+  } else {
+    for (int i = 0; (i < ADC_START_WAIT) && (_vN == 0); i++) {  // the first frame
+      delay(1);
+      poll();
+    }
+  }
+  return ok;
+}
+
+/**************************************************************************************************
+poll(): takes every frame that is ready (ADC_DMA), or one reading of each pin (ADC_ONESHOT)
+parameters: none
+returns: void
+***************************************************************************************************/
+void AdcSampler::poll() {
+  if (!_dma) {
+    add(analogRead(WDPin), analogRead(VoltsPin));
+    return;
+  }
+  adc_continuous_data_t* frame = NULL;
+  for (int f = 0; f < ADC_MAX_FRAMES; f++) {
+    if (!analogContinuousRead(&frame, 0) || (frame == NULL)) return;
+    int vaneRaw = 0;
+    int voltsRaw = 0;
+    for (int i = 0; i < 2; i++) {
+      if (frame[i].pin == WDPin) vaneRaw = frame[i].avg_read_raw;
+      else if (frame[i].pin == VoltsPin) voltsRaw = frame[i].avg_read_raw;
+    }
+    add(vaneRaw, voltsRaw);
+  }
+}
+
+/**************************************************************************************************
+add(): one reading of each pin into the latest values and the averages
+parameters: vaneRaw: int, voltsRaw: int: raw counts
+returns: void
+***************************************************************************************************/
+void AdcSampler::add(int vaneRaw, int voltsRaw) {
+  _vane = calibrate(vaneRaw, vaneCal, NUM_CAL(vaneCal));
+  _volts = calibrate(voltsRaw, voltsCal, NUM_CAL(voltsCal));
+  float s, c;
+  WindDir::unitVector(_vane, s, c);
+  _vSin += s;
+  _vCos += c;
+  _vN++;
+  _voltsSum += _volts;
+  _voltsN++;
+}
+
+/**************************************************************************************************
+takeVane(): the vector mean of the vane's readings since the last call, and starts again
+parameters: none
+returns: float: counts (0 to under ADC_COUNTS); the latest reading if there were none
+***************************************************************************************************/
+float AdcSampler::takeVane() {
+  if ((_vN == 0) || ((_vSin == 0.0f) && (_vCos == 0.0f))) {
+    _vN = 0;
+    return _vane;
+  }
+  float c = atan2f(_vSin, _vCos) * (ADC_COUNTS / (2.0f * (float)M_PI));
+  if (c < 0.0f) c += ADC_COUNTS;
+  if (c >= ADC_COUNTS) c = 0.0f;  // a tiny negative angle can round up to a whole turn
+  _vSin = _vCos = 0.0f;
+  _vN = 0;
+  return c;
+}
+
+/**************************************************************************************************
+takeVolts(): the mean supply reading since the last call, and starts again
+parameters: none
+returns: float: counts; the latest reading if there were none
+***************************************************************************************************/
+float AdcSampler::takeVolts() {
+  float v = (_voltsN > 0) ? _voltsSum / _voltsN : _volts;
+  _voltsSum = 0.0f;
+  _voltsN = 0;
+  return v;
+}
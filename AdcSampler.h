@@ -0,0 +1,43 @@
+#ifndef ADC_SAMPLER_H
+#define ADC_SAMPLER_H
+#include <stdint.h>
+#include "Arduino.h"
+#include "Config.h"
+
+/***********************************************************************************************
+* AdcSampler.h: header file for AdcSampler class: oversampled, averaged and calibrated wind    *
+*               vane and supply voltage readings                                               *
+*                                                                                              *
+* Version: 0.1                                                                                 *
+* Last updated: 17/10/2026                                                                     *
+* Author: Jim Gunther                                                                          *
+*                                                                                              *
+***********************************************************************************************/
+
+// One point of a calibration curve: raw counts in, counts out
+struct calPoint {
+  float in;
+  float out;
+};
+
+class AdcSampler {
+  public:
+    AdcSampler();
+    bool begin();
+    void poll();
+    float vane() { return _vane; }  // latest vane reading (counts: 0-ADC_COUNTS is one turn)
+    float takeVane();
+    float takeVolts();
+
+  private:
+    void add(int vaneRaw, int voltsRaw);
+    float _vane;   // latest readings (counts)
+    float _volts;
+    float _vSin;   // vane unit vectors summed since takeVane() ...
+    float _vCos;
+    int _vN;       // ... and how many
+    float _voltsSum;  // supply readings summed since takeVolts() ...
+    int _voltsN;      // ... and how many
+    bool _dma;        // continuous ADC running (false: one-shot reads in poll())
+};
+#endif
@@ -0,0 +1,100 @@
+#include "Batcher.h"
+#include "Telemetry.h"
+#include <stdio.h>
+#include <string.h>
+
+/***********************************************************************************************
+* Batcher.cpp: Batcher class: holds reports until BATCH_COUNT of them, BATCH_BYTES of payload  *
+*              or BATCH_LATENCY has built up, then writes them as one message                  *
+*                                                                                              *
+* Version: 0.1                                                                                 *
+* Last updated: 17/10/2026                                                                     *
+* Author: Jim Gunther                                                                          *
+*                                                                                              *
+***********************************************************************************************/
+
+#define BATCH_HDR 24  // room for the batch header
+
+Batcher::Batcher() {
+  clear();
+};
+
+/*******************************************************************************************
+add(): adds a report to the batch if it fits
+parameters: rep: const report&, now: unsigned long: millis()
+returns: bool: false if the batch is full (post it, then add again)
+********************************************************************************************/
+bool Batcher::add(const report& rep, unsigned long now) {
+  int len = recordLen(rep);
+  if ((_count == BATCH_SLOTS) || ((_count > 0) && (BATCH_HDR + _bytes + len > BATCH_BYTES))) return false;
+  if (_count == 0) _firstAt = now;
+  _reps[_count++] = rep;
+  _bytes += len;
+  return true;
+}
+
+/*******************************************************************************************
+due(): checks whether the batch should be posted now
+parameters: now: unsigned long: millis()
+returns: bool: true on reaching BATCH_COUNT reports or BATCH_LATENCY since the oldest
+********************************************************************************************/
+bool Batcher::due(unsigned long now) {
+  if (_count == 0) return false;
+  return (_count >= BATCH_COUNT) || (now - _firstAt >= BATCH_LATENCY);
+}
+
+/*******************************************************************************************
+finish(): writes the batch into buf as one payload (binary if TELEM_FORMAT is not CSV)
+parameters: now: unsigned long: millis(), buf: uint8_t*: output, len: int: size of buf
+returns: int: payload length, or -1 if it did not fit
+********************************************************************************************/
+int Batcher::finish(unsigned long now, uint8_t* buf, int len) {
+  int pos, i;
+  if (TELEM_FORMAT != TELEM_CSV) {
+    uint8_t rec[BIN_LEN];
+    buf[0] = BIN_BATCH;
+    pos = 1;
+    if (!Telemetry::putU(_count, buf, len, pos) || !Telemetry::putU((uint32_t)now, buf, len, pos)) return -1;
+    for (i = 0; i < _count; i++) {
+      int n = Telemetry::encode(_reps[i], BIN_REPORT, rec, BIN_LEN);
+      if ((n < 0) || !Telemetry::putU(n, buf, len, pos) || (pos + n > len)) return -1;
+      memcpy(buf + pos, rec, n);
+      pos += n;
+    }
+    return pos;
+  }
+  char starBuf[STARBUF_LEN];
+  char freqBuf[FREQBUF_LEN];
+  char windBuf[BUF_LEN];
+  char tagBuf[ICSV_LEN];
+  char* txt = (char*)buf;
+  pos = snprintf(txt, len, "$B%d,%lu", _count, now);
+  for (i = 0; (i < _count) && (pos < len); i++) {
+    WInputs::getStarCSV(_reps[i], starBuf);
+    if (!STAR_PAYLOAD) starBuf[0] = '\0';
+    WInputs::getFreqCSV(_reps[i], freqBuf);
+    WInputs::getWindCSV(_reps[i], windBuf);
+    WInputs::getTagCSV(_reps[i], tagBuf);
+    pos += snprintf(txt + pos, len - pos, "|S%u,%lu%s;%s;%s;%s", (unsigned)_reps[i].seq, _reps[i].millis, starBuf, freqBuf,
+                    windBuf, tagBuf);
+  }
+  return (pos < len) ? pos : -1;
+}
+
+void Batcher::clear() {
+  _count = 0;
+  _bytes = 0;
+  _firstAt = 0;
+}
+
+int Batcher::recordLen(const report& rep) {
+  if (TELEM_FORMAT != TELEM_CSV) {
+    uint8_t rec[BIN_LEN];
+    return Telemetry::encode(rep, BIN_REPORT, rec, BIN_LEN) + 2;  // + its length
+  }
+  char starBuf[STARBUF_LEN];
+  char freqBuf[FREQBUF_LEN];
+  WInputs::getStarCSV(rep, starBuf);
+  WInputs::getFreqCSV(rep, freqBuf);
+  return 60 + strlen(starBuf) + strlen(freqBuf);  // "|S<seq>,<millis>" + star + ';' + frequent + ';' + WD + ';' + tag
+}
@@ -0,0 +1,39 @@
+#ifndef BATCHER_H
+#define BATCHER_H
+#include "Config.h"
+#include "WInputs.h"
+
+/***********************************************************************************************
+* Batcher.h: header file for Batcher class: several intervals' reports in one MQTT message     *
+*                                                                                              *
+* Version: 0.1                                                                                 *
+* Last updated: 17/10/2026                                                                     *
+* Author: Jim Gunther                                                                          *
+*                                                                                              *
+* CSV batch (TOPIC_BATCH):  "$B<count>,<millis now>" then for each report, after a '|':        *
+*                           "S<seq>,<millis>" + star CSV + ";" + frequent CSV + ";" + WD       *
+*                           summary CSV + ";" + profile tag CSV (star CSV empty if             *
+*                           STAR_PAYLOAD is 0)                                                 *
+* Binary batch:             BIN_BATCH byte, count, millis now (varints), then per report its   *
+*                           length (varint) and its Telemetry encoding                         *
+* A report's age at posting is (millis now - its millis).                                      *
+***********************************************************************************************/
+
+class Batcher {
+  public:
+    Batcher();
+    bool add(const report& rep, unsigned long now);
+    bool due(unsigned long now);
+    int finish(unsigned long now, uint8_t* buf, int len);
+    void clear();
+    int count() { return _count; }
+    const report& get(int i) { return _reps[i]; }
+
+  private:
+    int recordLen(const report& rep);
+    report _reps[BATCH_SLOTS];  // kept so a failed post can go to the record log
+    int _count;
+    int _bytes;               // encoded size of the reports so far
+    unsigned long _firstAt;   // when the oldest report was added
+};
+#endif
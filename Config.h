@@ -39,26 +39,145 @@
 #define TOPIC_MESS "ws/messages"
 #define TOPIC_CSV "ws/csv"
 #define TOPIC_STAR "ws/wdstar"
+#define TOPIC_BIN "ws/bin"
+#define TOPIC_BATCH "ws/batch"
+#define TOPIC_STATS "ws/stats"
+#define TOPIC_WIND "ws/wind"
+#define TOPIC_METRICS "ws/metrics"
+#define TOPIC_HEALTH "ws/health"
+#define TOPIC_CONFIG "ws/config"           // settings from the Shed (publish retained), kept subscribed ...
+#define TOPIC_APPLIED "ws/config/applied"  // ... and echoed here once applied at an interval boundary
+
+// Report format: CSV on TOPIC_CSV/TOPIC_STAR (as always), binary on TOPIC_BIN, or both
+#define TELEM_CSV 0
+#define TELEM_BIN 1
+#define TELEM_BOTH 2
+#ifndef TELEM_FORMAT
+#define TELEM_FORMAT TELEM_CSV
+#endif
+#define BIN_VERSION 2  // 2: Rr and Rp items
+#define BIN_LEN 442  // worst-case binary report; typically 50-80 bytes
+#define BIN_BATCH (0x80 | BIN_VERSION)  // first byte of a binary batch (see Batcher.h)
+
+// Batching: several intervals' reports in one publish on TOPIC_BATCH. BATCH_COUNT 1 posts each
+// report on its own, as always; a batch also goes when BATCH_BYTES or BATCH_LATENCY is reached
+#ifndef BATCH_COUNT
+#define BATCH_COUNT 1
+#endif
+#define BATCH_MAX 16          // most reports in one batch
+#define BATCH_SLOTS ((BATCH_COUNT < BATCH_MAX) ? BATCH_COUNT : BATCH_MAX)  // reports held: just 1 with batching off
+#define BATCH_BYTES 2048      // largest batch payload
+#define BATCH_LATENCY 600000  // milliseconds the oldest report may wait in a batch
+#define MQTT_BUF_LEN ((BATCH_COUNT > 1) ? BATCH_BYTES + 64 : 512)  // PubSubClient buffer: payload + topic + header
 
 // Other constants
-#define POLL_COUNT 12 // number of loops between successive revs calculations 
-#define NUM_ITEMS 10
-#define INIT_WAIT 50
+#define GUST_WINDOW 3000000UL // usecs: WMO 3-second gust averaging window
+#define GUST_HIST 128          // anemometer pulse times kept for the gust window (> 3 secs of storm)
+#define PULSE_RING_LEN 256     // pulse times queued by the ISR between polls (power of 2)
+#define MARGIN_US 5000         // minimum usecs between anemometer pulses (contact bounce)
+#define RAIN_MM_PER_TIP 0.3f   // mm of rain per bucket tip (the gauge's calibration)
+#define RAIN_MARGIN_MS 500     // minimum msecs between tips: bounce, and both edges of one tip
+#define TIP_RING_LEN 16        // tip times queued by the ISR between polls (power of 2)
+#define RAIN_HIST 128          // tip times kept for the rain rate (> RAIN_RATE_WINDOW of a cloudburst)
+#define RAIN_RATE_WINDOW 300000UL // msecs: the rain rate reported (Rr) is the mean over this ...
+#define RAIN_PEAK_WINDOW 60000UL  // ... and the peak (Rp) the highest mean over this during the interval
+#define RAIN_STOP_MS 1800000UL    // msecs after the last tip that the rain is taken to have stopped
+// Wind and rain counting: an interrupt per edge (as always), or the PCNT peripheral read at each poll
+#define COUNT_ISR 0
+#define COUNT_PCNT 1
+#ifndef COUNT_BACKEND
+#define COUNT_BACKEND COUNT_ISR
+#endif
+#define PCNT_HIGH 30000        // PCNT units clear at this count
+#define PCNT_GLITCH_NS 12000   // PCNT glitch filter (about the most the hardware will take)
+// Power management between sampling ticks (COUNT_PCNT only: edge interrupts would be missed); see
+// startLightSleep(). Needs a build with CONFIG_PM_ENABLE; otherwise nothing changes.
+#ifndef LIGHT_SLEEP
+#define LIGHT_SLEEP 0
+#endif
+#if LIGHT_SLEEP && (COUNT_BACKEND == COUNT_ISR)
+#error "LIGHT_SLEEP needs COUNT_BACKEND COUNT_PCNT"
+#endif
+#define PM_MAX_MHZ 240
+#define PM_MIN_MHZ 80
+// Wind vane and supply voltage: the continuous ADC, DMA filling frames of ADC_OVERSAMPLE conversions
+// per pin that are averaged into one reading (ADC_DMA), or one conversion per pin per loop (ADC_ONESHOT)
+#define ADC_ONESHOT 0
+#define ADC_DMA 1
+#ifndef ADC_BACKEND
+#if LIGHT_SLEEP
+#define ADC_BACKEND ADC_ONESHOT  // the continuous ADC holds the clocks up, so there would be no sleep
+#else
+#define ADC_BACKEND ADC_DMA
+#endif
+#endif
+#define ADC_HZ 20000           // conversions per second, both pins together (the ESP32's least)
+#define ADC_OVERSAMPLE (ADC_HZ / 2 * LOOP_TIME / 1000)  // conversions per pin in a frame: one frame a loop
+#define ADC_MAX_FRAMES 2       // frames the core's driver keeps: poll() takes every one that is ready
+#define ADC_START_WAIT 400     // msecs begin() waits for the first frame (a frame takes LOOP_TIME)
+#define ADC_COUNTS 4096.0f     // raw counts (12 bits): one turn of the vane
+// Calibration curves: {counts in, counts out} points, ascending; straight through is no correction
+#define VANE_CAL { { 0.0f, 0.0f }, { 4096.0f, 4096.0f } }
+#define VOLTS_CAL { { 0.0f, 0.0f }, { 4096.0f, 4096.0f } }
+#define INIT_WAIT 50      // tenths of a second to wait for the Shed's report interval
+#define NTP_RETRY 2000    // milliseconds between NTP attempts until one succeeds
 #define NUM_SHIFT7 32
 #define CALM 33
-#define INDEXER "RfWsGuWdTpHmPrL1L2Vo"
+
+// Meteo items, in report order (CSV fields, binary, stats): adding one is one line here and its reader.
+//   X(id, name, reader, period, scale, noData, deadband, silence)
+//   reader:   WInputs member giving the value: bool reader(unsigned long now, float& val)
+//   period:   ms between samples, averaged over the interval; 0: read once at the interval end
+//   scale:    binary fixed-point multiplier
+//   noData:   reported when a sampled item got no samples
+//   deadband, silence (secs): report by exception (below); a negative deadband means every report
+#define METEO_ITEMS(X)                                    \
+  X(RF, "Rf", readTips,     0,    1,   0,    -1,  0)      \
+  X(WS, "Ws", readRevs,     0,    1,   0,    -1,  0)      \
+  X(GU, "Gu", readGust,     0,    100, 0,    -1,  0)      \
+  X(WD, "Wd", readVane,     0,    1,   0,    -1,  0)      \
+  X(TP, "Tp", readTemp,     1000, 100, 99,   0.2, 900)    \
+  X(HM, "Hm", readHum,      1000, 100, 98,   1.0, 900)    \
+  X(PR, "Pr", readPres,     1000, 100, 0.97, 0.2, 900)    \
+  X(L1, "L1", readLightA,   1000, 10,  96,   5,   900)    \
+  X(L2, "L2", readLightB,   1000, 10,  95,   5,   900)    \
+  X(VO, "Vo", readVolts,    250,  1,   0,    20,  3600)   \
+  X(RR, "Rr", readRainRate, 0,    100, 0,    -1,  0)      \
+  X(RP, "Rp", readRainPeak, 0,    100, 0,    -1,  0)
+
+#define ITEM_ID(id, name, reader, period, scale, noData, deadband, silence) IT_##id,
+enum itemId { METEO_ITEMS(ITEM_ID) NUM_ITEMS };
+#define ITEMS_ALL ((1 << NUM_ITEMS) - 1)
+// Report by exception: an item goes out only when it has moved more than its deadband since it last
+// went out, or its silence has passed
+#ifndef REPORT_BY_EXCEPTION
+#define REPORT_BY_EXCEPTION 0
+#endif
+// Rr and Rp on TOPIC_CSV (and CSV batches): off until the Shed's ws/csv reader takes the two extra fields.
+// They are the last items, so the others keep their places either way; binary reports always carry them.
+#ifndef CSV_RAIN_RATE
+#define CSV_RAIN_RATE 0
+#endif
+#define CSV_ITEMS (CSV_RAIN_RATE ? NUM_ITEMS : IT_RR)
 
 // Various character buffers' lengths
 #define BUF_LEN 88
 #define STARBUF_LEN 132
+#define FREQBUF_LEN (NUM_ITEMS * (FITEM_LEN + 2) + 1)  // frequent data: room for values of 10000+
+#define STATSBUF_LEN 200
 #define ICSV_LEN 12 // buffer size for item's CSV
-#define INAME_LEN 3 // buffer size for Meteo name (2 chars + null)
 #define HITEM_LEN 3 // string length for star data item
 #define FITEM_LEN 8 // string length for "frequent" data item
 #define ICBUF_LEN 10
+#define CFG_LEN 160 // TOPIC_CONFIG payload, and its echo
 //#define HRREQ_LEN 6 // length of hourly i/c request message: HxxDxx (hour and date requested)
 
 #define NUL_WD 18  // code for wind direction NULL value
+#define WD_OFFSET 0.0f  // degrees from north of the vane's 0 (added to the mean WD on TOPIC_WIND)
+// Set STAR_PAYLOAD to 0 to leave the 32-bin WD star out of posts once the Pi uses the WD summary
+#ifndef STAR_PAYLOAD
+#define STAR_PAYLOAD 1
+#endif
 #define MIN_LIGHT 10
 
 // Timings, etc
@@ -69,6 +188,116 @@
 #define ZONE40 40
 #define ZONE0 120
 
+// Activity profiles (see RateControl.h): calm, normal, storm
+#define PROF_WINDOW 60          // seconds of revs and tips the profile is judged on
+#define PROF_HOLD 300           // seconds the lower thresholds must hold before moving down a profile
+#define CALM_REVS_ON 0.1f       // revs/sec: calm at or below this (and no tips) ...
+#define CALM_REVS_OFF 0.3f      // ... until above this, or any tip
+#define STORM_REVS_ON 8.0f      // revs/sec: storm at or above this ...
+#define STORM_REVS_OFF 5.0f     // ... until below this (and the two below) for PROF_HOLD
+#define STORM_SD_ON 4.0f        // revs/sec standard deviation, second to second: gustiness
+#define STORM_SD_OFF 3.0f
+#define STORM_TIPS_ON 5         // bucket tips in PROF_WINDOW
+#define STORM_TIPS_OFF 2
+#define PROF_INTVL_PCT { 400, 100, 50 }  // report interval, % of the Shed's, for each profile
+#define PROF_PERIOD_X { 4, 1, 1 }        // item periods and SENSOR_PERIOD multiplied by these
+
+// Store and forward: reports that fail to post wait in flash (LittleFS) for the broker
+#define LOG_FILE "/reports.bin"
+#define LOG_SLOTS 480       // 4 hours of 30-second reports
+#define LOG_BATCH 4         // logged reports replayed per network task pass
+#define SEQ_BLOCK 64        // report sequence numbers reserved per flash write
+#define WIFI_GIVEUP 1800000 // milliseconds without Wi-Fi before rebooting
+#define WARM_WAIT 3000      // milliseconds to reach the cached access point before scanning instead
+
+// MQTT connection (see MqttLink.h)
+#define MQTT_BACKOFF_MIN 1000  // milliseconds: first retry, and the backoff after each success
+#define MQTT_BACKOFF_MAX 60000 // the backoff stops doubling here
+#define MQTT_CONNECT_MS 2000   // TCP connect timeout
+#define MQTT_SOCK_SECS 2       // seconds to wait for CONNACK (the library default is 15)
+#define MQTT_KEEPALIVE 15      // seconds between pings while idle
+#define MQTT_PUB_FAILS 3       // publishes failing in a row that drop the link
+#define OUT_DATA_BYTES 4096    // outbound queue (see Outbox.h): reports, batches, interval request
+#define OUT_DIAG_BYTES 1024    // messages and metrics
+#define OUT_PER_TICK 4         // most publishes per network task pass
+#if OUT_DATA_BYTES < BATCH_BYTES + 16
+#error "OUT_DATA_BYTES must hold a whole batch"
+#endif
+
+// I2C sensors: addresses and acquisition timings (milliseconds)
+#define AHT_ADDR 0x38
+#define BMP_ADDR 0x77
+#define BHA_ADDR 0x23
+#define BHB_ADDR 0x5c
+#define BMP_OSS 3          // BMP180 oversampling setting (ultra high resolution)
+#define SENSOR_PERIOD 1000 // how often each I2C sensor is read
+#define AHT_CONV 80        // conversion time budgets: the bus is left alone for this long
+#define BMP_TEMP_CONV 5
+#define BMP_PRES_CONV 26
+#define I2C_TIMEOUT 500    // conversion abandoned (and restarted) after this long
+#define SENSOR_STALE 5000  // older readings are reported as the sensor's failure value
+#define I2C_WIRE_TIMEOUT 20    // most one I2C transaction may take (a stuck bus costs no more)
+#define I2C_FAILS 3            // failures in a row before a device is taken as down
+#define I2C_BACKOFF_MIN 5000   // first wait before begin() is tried again on a down device ...
+#define I2C_BACKOFF_MAX 300000 // ... doubling to this
+#define I2C_RECOVER_MS 10000   // least time between bus recoveries
+
+// Tasks: sampling runs on its own core at a fixed LOOP_TIME cadence; Wi-Fi and MQTT on the other, OTA under them
+#define SAMPLE_CORE 1
+#define NET_CORE 0
+#define SAMPLE_PRIO 5
+#define NET_PRIO 2
+#define SAMPLE_STACK 4096
+#define NET_STACK 8192
+#define NET_TICK 10       // milliseconds between network task passes
+#define OTA_CORE NET_CORE // firmware updates (see OtaServer.h): below the network task on its core
+#define OTA_PRIO 1
+#define OTA_STACK 8192
+#define OTA_TICK 20       // milliseconds between OTA task passes, and its pause after each ...
+#define OTA_CHUNKS_PER_TICK 3  // ... this many upload chunks (up to 1436 bytes each) written to flash
+#define OTA_USER "MIS"    // the update page's HTTP login
+#define OTA_PASS "mispas"
+#define REPORT_Q_LEN 8    // intervals held between sampling and network tasks (power of 2)
+#define MSG_Q_LEN 8       // diagnostic messages from the sampling task (power of 2)
+#define CFG_Q_LEN 2       // TOPIC_CONFIG changes waiting for an interval boundary, and their echoes (power of 2)
+#define CFG_RPT_MAX 14400         // most loops TOPIC_CONFIG may set the report interval to (an hour)
+#define CFG_PERIOD_MAX 3600000UL  // longest item sampling period it may set (msecs)
+
+// Zone ids for timing each part of the sampling and network tasks (see ZoneMetrics.h; the host
+// simulation in sim/ also charges them CPU time)
+#define ZT_EVERY 0      // ZONE 1: every loop
+#define ZT_WD 1         // ZONE 4
+#define ZT_BLINK 2      // ZONE 12
+#define ZT_REPORT 3     // report interval zone
+#define ZT_OTA 4        // OTA web server (its own task, on the network core)
+#define ZT_MQTT 5       // qtClient.loop()
+#define ZT_RECONNECT 6  // MQTT connect attempts
+#define ZT_PUBLISH 7    // formatting and posting reports and messages
+#define ZT_I2C 8        // I2C sensor acquisition
+#define NUM_ZT 9
+#define ZT_IDLE -1      // waiting for the next tick
+#define ZS_SAMPLE 0     // zone slots: each task marks its own, however tasks share a core
+#define ZS_NET 1
+#define ZS_OTA 2
+#define NUM_ZS 3
+#define METRIC_BUCKETS 24   // log2 latency buckets: up to 8 seconds
+#define METRICS_MS 300000   // how often the zone latencies are posted on TOPIC_METRICS
+#define METRICS_LEN 400
+// Memory headroom (see MemWatch.h): sampled and posted on TOPIC_HEALTH every METRICS_MS; below any of
+// these limits the ESP reboots, straight after the next interval has gone out
+#define MEM_MIN_FREE 24576    // bytes of free heap
+#define MEM_MIN_BLOCK 8192    // bytes in the largest free block (fragmentation)
+#define MEM_MAX_DRIFT 16384   // bytes of heap lost since the first sample after setup
+#define MEM_MIN_STACK 512     // bytes of stack either task has never touched
+#define REBOOT_WAIT 600000    // milliseconds to wait for the queued messages to go before rebooting anyway
+void zoneMark(int slot, int zone);
+#ifdef HOST_SIM
+void simZone(int zone);
+#define ZONE_MARK(slot, z) (simZone(z), zoneMark(slot, z))
+#else
+#define ZONE_MARK(slot, z) zoneMark(slot, z)
+#endif
+
 // Pin numbers == GPIO numbers
 const int RevsPin = 25;  // pin connected to wind speed rotation counter (interrupt 0) 
 const int RainPin = 33; // pin connected to rain gauge - buckets tipped (interrupt 1);
@@ -76,5 +305,7 @@ const int WDPin = 32; // vane (wind direction)
 const int VoltsPin = 34;  // raw analog value, not volts!
 const int LEDPin = 19;		// Green LED
 const int RedPin = 26;		// Red LED
+const int SDAPin = 21;  // I2C (the ESP32 defaults), driven by hand to recover a stuck bus
+const int SCLPin = 22;
 
 #endif
\ No newline at end of file
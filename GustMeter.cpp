@@ -0,0 +1,86 @@
+#include "GustMeter.h"
+
+/***********************************************************************************************
+* GustMeter.cpp: GustMeter class: WMO-style 3-second running-mean gust and peak instantaneous  *
+*                speed, worked out from the times between anemometer pulses                   *
+*                                                                                              *
+* Version: 0.1                                                                                 *
+* Last updated: 17/10/2026                                                                     *
+* Author: Jim Gunther                                                                          *
+*                                                                                              *
+* Speeds are kept in the units the Pi already uses for gusts (revolutions per 3 seconds) but   *
+* are no longer whole numbers, and do not depend on when the sampling loop happens to run.    *
+***********************************************************************************************/
+
+GustMeter::GustMeter() {
+  _count = 0;
+  _first = 0;
+  _lastCount = 0;
+  reset();
+};
+
+/**************************************************************************************************
+addPulse(): takes one anemometer pulse and updates the interval's gust and peak
+parameters: tUs: uint32_t: pulse time (usecs; wraps every 71 mins, only differences are used)
+returns: void
+***************************************************************************************************/
+void GustMeter::addPulse(uint32_t tUs) {
+  if (_count > 0) {
+    uint32_t dt = tUs - _hist[(_first + _count - 1) % GUST_HIST];
+    if (dt > 0) {
+      float inst = (float)GUST_WINDOW / (float)dt;
+      if (inst > _peak) _peak = inst;
+    }
+  }
+  if (_count == GUST_HIST) {  // window longer than the history: lose the oldest
+    _first = (_first + 1) % GUST_HIST;
+    _count--;
+  }
+  _hist[(_first + _count) % GUST_HIST] = tUs;
+  _count++;
+
+  // Drop pulses that ended more than one interval before the window started
+  while ((_count > 2) && (tUs - _hist[(_first + 1) % GUST_HIST] > GUST_WINDOW)) {
+    _first = (_first + 1) % GUST_HIST;
+    _count--;
+  }
+  if (_count < 2) return;
+
+  // Whole revolutions inside the window, plus the part of the one straddling its start
+  int inside = _count - 1;
+  uint32_t oldest = _hist[_first];
+  uint32_t span = tUs - oldest;
+  float revs;
+  if (span <= GUST_WINDOW) {
+    revs = (float)inside;  // history does not reach back past the window start
+  } else {
+    uint32_t first = _hist[(_first + 1) % GUST_HIST];
+    uint32_t straddle = first - oldest;
+    revs = (float)(inside - 1) + (float)(GUST_WINDOW - (tUs - first)) / (float)straddle;
+  }
+  if (revs > _gust) _gust = revs;
+}
+
+/**************************************************************************************************
+addCount(): takes a count of revs with no pulse times (hardware counter), as pulses evenly spaced
+            since the last count
+parameters: tUs: uint32_t: time of the count (usecs), revs: int: revs since the last count
+returns: void
+***************************************************************************************************/
+void GustMeter::addCount(uint32_t tUs, int revs) {
+  uint32_t span = tUs - _lastCount;
+  if (_lastCount != 0) {
+    for (int i = 1; i <= revs; i++) addPulse(_lastCount + (uint32_t)((uint64_t)span * i / revs));
+  }
+  _lastCount = tUs;
+}
+
+/**************************************************************************************************
+reset(): starts a new report interval (the pulse history carries on across the boundary)
+parameters: none
+returns: void
+***************************************************************************************************/
+void GustMeter::reset() {
+  _gust = 0.0f;
+  _peak = 0.0f;
+}
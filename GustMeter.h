@@ -0,0 +1,31 @@
+#ifndef GUST_METER_H
+#define GUST_METER_H
+#include <stdint.h>
+#include "Config.h"
+
+/***********************************************************************************************
+* GustMeter.h: header file for GustMeter class: gusts from anemometer pulse timestamps         *
+*                                                                                              *
+* Version: 0.1                                                                                 *
+* Last updated: 17/10/2026                                                                     *
+* Author: Jim Gunther                                                                          *
+*                                                                                              *
+***********************************************************************************************/
+class GustMeter {
+  public:
+    GustMeter();
+    void addPulse(uint32_t tUs);
+    void addCount(uint32_t tUs, int revs);
+    void reset();
+    float getGust() { return _gust; }  // highest 3-sec running mean this interval (revs per 3 secs)
+    float getPeak() { return _peak; }  // highest single-revolution speed this interval (revs per 3 secs)
+
+  private:
+    uint32_t _hist[GUST_HIST];  // recent pulse times (usecs), oldest at _first
+    int _count;
+    int _first;
+    float _gust;
+    float _peak;
+    uint32_t _lastCount;  // time of the last addCount() (usecs)
+};
+#endif
@@ -0,0 +1,378 @@
+#include "I2CSensors.h"
+#include "Arduino.h"
+
+/***********************************************************************************************
+* I2CSensors.cpp: I2CSensors class: starts a conversion, returns at once and collects the      *
+*                 result on a later tick, so no read ever waits on a sensor                    *
+*                                                                                              *
+* Version: 0.1                                                                                 *
+* Last updated: 17/10/2026                                                                     *
+* Author: Jim Gunther                                                                          *
+*                                                                                              *
+* Each device has a conversion time budget (the bus is left alone until it has passed) and a   *
+* timeout (conversion abandoned and restarted). A tick is at most a few short transactions,    *
+* each bounded by I2C_WIRE_TIMEOUT, plus at most one begin() for a device that is down.        *
+***********************************************************************************************/
+
+static const char* devNames[NUM_DEVS] = { "BMP180", "AHT20", "BH1750a", "BH1750b" };
+
+I2CSensors::I2CSensors() : _bh1750a(BHA_ADDR), _bh1750b(BHB_ADDR) {};
+
+/**************************************************************************************************
+begin(): starts the bus and the four sensors via their libraries (reading the BMP180 calibration);
+         any that fail are tried again by tick()
+parameters: none
+returns: uint: status bits, set for each sensor that failed (1 BMP, 2 AHT, 4 BH1750a, 8 BH1750b)
+***************************************************************************************************/
+uint I2CSensors::begin() {
+  int i;
+  unsigned long now = millis();
+  _status = 0;
+  _period = SENSOR_PERIOD;
+  _recoveredAt = 0;
+  _recoveries = 0;
+  _busNews = false;
+  Wire.begin(SDAPin, SCLPin);
+  Wire.setTimeOut(I2C_WIRE_TIMEOUT);
+  for (i = 0; i < NUM_DEVS; i++) {
+    _dev[i].state = ST_IDLE;
+    _dev[i].tStart = 0;
+    _dev[i].tLast = 0;
+    _dev[i].budget = 0;
+    _dev[i].timeout = I2C_TIMEOUT;
+    _dev[i].reads = 0;
+    _dev[i].timeouts = 0;
+    _dev[i].fails = 0;
+    _dev[i].tries = 1;
+    _dev[i].news = NEWS_NONE;
+    _dev[i].backoff = I2C_BACKOFF_MIN;
+    _dev[i].retryAt = now + I2C_BACKOFF_MIN;
+    if (!startDev(i)) _status |= (1 << i);
+  }
+  _temp = _hum = _pres = _luxA = _luxB = 0.0f;
+  return _status;
+}
+
+/**************************************************************************************************
+tick(): moves each working sensor's acquisition on by one step (never waiting for a conversion),
+        and tries one that is down again if its backoff is over
+parameters: now: unsigned long: millis()
+returns: void
+***************************************************************************************************/
+void I2CSensors::tick(unsigned long now) {
+  if ((_status & 1) == 0) stepBMP(_dev[DEV_BMP], now);
+  if ((_status & 2) == 0) stepAHT(_dev[DEV_AHT], now);
+  if ((_status & 4) == 0) stepBH(_dev[DEV_BHA], _bh1750a, _luxA, now);
+  if ((_status & 8) == 0) stepBH(_dev[DEV_BHB], _bh1750b, _luxB, now);
+  if (_status != 0) retry(now);
+}
+
+/**************************************************************************************************
+startDev(): one device's library begin() (and the BMP180's calibration)
+parameters: dev: int: device index
+returns: bool: true if it answered
+***************************************************************************************************/
+bool I2CSensors::startDev(int dev) {
+  switch (dev) {
+    case DEV_BMP:
+      return _bmp.begin() && readCalibration();
+    case DEV_AHT:
+      return _aht.begin();
+    case DEV_BHA:
+      return _bh1750a.begin();
+    case DEV_BHB:
+      return _bh1750b.begin(BH1750::CONTINUOUS_HIGH_RES_MODE, BHB_ADDR);
+  }
+  return false;
+}
+
+/**************************************************************************************************
+retry(): begin() again for the first down device whose backoff is over (one per tick: the libraries
+         wait a few milliseconds); on failure its backoff doubles up to I2C_BACKOFF_MAX. If every
+         device is down the bus is recovered first.
+parameters: now: unsigned long: millis()
+returns: void
+***************************************************************************************************/
+void I2CSensors::retry(unsigned long now) {
+  for (int i = 0; i < NUM_DEVS; i++) {
+    i2cDev& d = _dev[i];
+    if (((_status & (1 << i)) == 0) || ((long)(now - d.retryAt) < 0)) continue;
+    if (_status == (1 << NUM_DEVS) - 1) recoverBus(now);
+    d.tries++;
+    if (startDev(i)) {
+      _status &= ~(1 << i);
+      d.state = ST_IDLE;
+      d.fails = 0;
+      d.news = NEWS_UP;
+    } else {
+      d.retryAt = now + d.backoff;
+      d.backoff = min(2 * d.backoff, (unsigned long)I2C_BACKOFF_MAX);
+    }
+    return;
+  }
+}
+
+/**************************************************************************************************
+fail(): counts a failed acquisition; I2C_FAILS in a row and the device is down. A device holding
+        SDA low has stuck the bus, which is then recovered.
+parameters: dev: int: device index, now: unsigned long: millis()
+returns: void
+***************************************************************************************************/
+void I2CSensors::fail(int dev, unsigned long now) {
+  i2cDev& d = _dev[dev];
+  d.state = ST_IDLE;
+  if (digitalRead(SDAPin) == LOW) recoverBus(now);
+  if (++d.fails < I2C_FAILS) return;
+  _status |= (1 << dev);
+  d.news = NEWS_DOWN;
+  d.tries = 0;
+  d.backoff = I2C_BACKOFF_MIN;
+  d.retryAt = now + I2C_BACKOFF_MIN;
+}
+
+/**************************************************************************************************
+recoverBus(): frees a bus left stuck by a device part way through sending (it holds SDA low until
+              clocked on): up to 9 SCL pulses until SDA is released, a STOP, then Wire started
+              again. Not more often than I2C_RECOVER_MS.
+parameters: now: unsigned long: millis()
+returns: void
+***************************************************************************************************/
+void I2CSensors::recoverBus(unsigned long now) {
+  if ((_recoveredAt != 0) && (now - _recoveredAt < I2C_RECOVER_MS)) return;
+  _recoveredAt = now | 1;
+  _recoveries++;
+  _busNews = true;
+  Wire.end();
+  pinMode(SDAPin, INPUT_PULLUP);
+  pinMode(SCLPin, OUTPUT_OPEN_DRAIN);
+  digitalWrite(SCLPin, HIGH);
+  for (int i = 0; (i < 9) && (digitalRead(SDAPin) == LOW); i++) {
+    digitalWrite(SCLPin, LOW);
+    delayMicroseconds(5);
+    digitalWrite(SCLPin, HIGH);
+    delayMicroseconds(5);
+  }
+  pinMode(SDAPin, OUTPUT_OPEN_DRAIN);  // STOP: SDA rises while SCL is high
+  digitalWrite(SDAPin, LOW);
+  delayMicroseconds(5);
+  digitalWrite(SDAPin, HIGH);
+  delayMicroseconds(5);
+  Wire.begin(SDAPin, SCLPin);
+  Wire.setTimeOut(I2C_WIRE_TIMEOUT);
+  for (int i = 0; i < NUM_DEVS; i++) _dev[i].state = ST_IDLE;  // conversions in progress are lost
+}
+
+/**************************************************************************************************
+getNews(): the next health change not yet collected: a device down or back, or a bus recovery
+parameters: buf: char*: receives the message, len: int: its size
+returns: bool: false if there is none
+***************************************************************************************************/
+bool I2CSensors::getNews(char* buf, int len) {
+  if (_busNews) {
+    _busNews = false;
+    snprintf(buf, len, "I2C bus recovered (%u so far)", (unsigned)_recoveries);
+    return true;
+  }
+  for (int i = 0; i < NUM_DEVS; i++) {
+    i2cDev& d = _dev[i];
+    if (d.news == NEWS_DOWN) {
+      snprintf(buf, len, "%s down after %u failures (%u timeouts so far)", devNames[i], (unsigned)d.fails,
+               (unsigned)d.timeouts);
+    } else if (d.news == NEWS_UP) {
+      snprintf(buf, len, "%s up after %u tries", devNames[i], (unsigned)d.tries);
+    } else {
+      continue;
+    }
+    d.news = NEWS_NONE;
+    return true;
+  }
+  return false;
+}
+
+/**************************************************************************************************
+isFresh(): checks a sensor is working and its last reading is recent enough to report
+parameters: dev: int: device index, now: unsigned long: millis()
+returns: bool: true if the reading can be used
+***************************************************************************************************/
+bool I2CSensors::isFresh(int dev, unsigned long now) {
+  if (_status & (1 << dev)) return false;
+  if (_dev[dev].reads == 0) return false;
+  return (now - _dev[dev].tLast) < SENSOR_STALE;
+}
+
+void I2CSensors::start(i2cDev& d, unsigned long now, int state, unsigned long budget) {
+  d.state = state;
+  d.tStart = now;
+  d.budget = budget;
+}
+
+void I2CSensors::finish(i2cDev& d, unsigned long now) {
+  d.state = ST_IDLE;
+  d.tLast = now;
+  d.reads++;
+  d.fails = 0;
+}
+
+/**************************************************************************************************
+stepAHT(): AHT20: trigger a measurement, then after AHT_CONV read it if the busy bit has cleared
+parameters: d: i2cDev&: the AHT's state, now: unsigned long: millis()
+returns: void
+***************************************************************************************************/
+void I2CSensors::stepAHT(i2cDev& d, unsigned long now) {
+  static const uint8_t trigger[3] = { 0xAC, 0x33, 0x00 };
+  uint8_t buf[6];
+  switch (d.state) {
+    case ST_IDLE:
+      if ((now - d.tLast < _period) && (d.reads > 0)) return;
+      if (command(AHT_ADDR, trigger, 3)) start(d, now, ST_CONV, AHT_CONV);
+      else fail(DEV_AHT, now);
+      break;
+    case ST_CONV:
+      if (now - d.tStart < d.budget) return;
+      if ((Wire.requestFrom((uint8_t)AHT_ADDR, (uint8_t)6) == 6)) {
+        for (int i = 0; i < 6; i++) buf[i] = Wire.read();
+        if ((buf[0] & 0x80) == 0) {  // not busy
+          uint32_t rh = ((uint32_t)buf[1] << 12) | ((uint32_t)buf[2] << 4) | (buf[3] >> 4);
+          uint32_t rt = ((uint32_t)(buf[3] & 0x0F) << 16) | ((uint32_t)buf[4] << 8) | buf[5];
+          _hum = rh * 100.0f / 1048576.0f;
+          _temp = rt * 200.0f / 1048576.0f - 50.0f;
+          finish(d, now);
+          return;
+        }
+      }
+      if (now - d.tStart > d.timeout) {
+        d.timeouts++;
+        fail(DEV_AHT, now);
+      }
+      break;
+  }
+}
+
+/**************************************************************************************************
+stepBMP(): BMP180: temperature conversion, then pressure conversion (oversampling BMP_OSS); each
+           collected once its budget has passed and the SCO bit says it is finished. A status or
+           result read that fails counts towards the timeout like a conversion still running.
+parameters: d: i2cDev&: the BMP's state, now: unsigned long: millis()
+returns: void
+***************************************************************************************************/
+void I2CSensors::stepBMP(i2cDev& d, unsigned long now) {
+  uint8_t cmd[2] = { 0xF4, 0x2E };
+  uint8_t buf[3];
+  if (d.state == ST_IDLE) {
+    if ((now - d.tLast < _period) && (d.reads > 0)) return;
+    if (command(BMP_ADDR, cmd, 2)) start(d, now, ST_CONV, BMP_TEMP_CONV);
+    else fail(DEV_BMP, now);
+    return;
+  }
+  if (now - d.tStart < d.budget) return;
+  bool done = readRegs(BMP_ADDR, 0xF4, buf, 1) && ((buf[0] & 0x20) == 0) &&  // not still converting ...
+              readRegs(BMP_ADDR, 0xF6, buf, (d.state == ST_CONV) ? 2 : 3);   // ... and the result read
+  if (!done) {  // tried again next poll, until the timeout
+    if (now - d.tStart > d.timeout) {
+      d.timeouts++;
+      fail(DEV_BMP, now);
+    }
+    return;
+  }
+  if (d.state == ST_CONV) {
+    _ut = ((int32_t)buf[0] << 8) | buf[1];
+    cmd[1] = 0x34 + (BMP_OSS << 6);
+    if (command(BMP_ADDR, cmd, 2)) start(d, now, ST_CONV2, BMP_PRES_CONV);
+    else fail(DEV_BMP, now);
+    return;
+  }
+  int32_t up = (((int32_t)buf[0] << 16) | ((int32_t)buf[1] << 8) | buf[2]) >> (8 - BMP_OSS);
+
+  // Datasheet compensation, integer arithmetic throughout
+  int32_t x1 = ((_ut - (int32_t)_ac6) * (int32_t)_ac5) >> 15;
+  int32_t x2 = ((int32_t)_mc << 11) / (x1 + _md);
+  int32_t b5 = x1 + x2;
+  int32_t b6 = b5 - 4000;
+  x1 = (_b2 * ((b6 * b6) >> 12)) >> 11;
+  x2 = (_ac2 * b6) >> 11;
+  int32_t x3 = x1 + x2;
+  int32_t b3 = ((((int32_t)_ac1 * 4 + x3) << BMP_OSS) + 2) / 4;
+  x1 = (_ac3 * b6) >> 13;
+  x2 = (_b1 * ((b6 * b6) >> 12)) >> 16;
+  x3 = ((x1 + x2) + 2) >> 2;
+  uint32_t b4 = ((uint32_t)_ac4 * (uint32_t)(x3 + 32768)) >> 15;
+  uint32_t b7 = ((uint32_t)up - b3) * (uint32_t)(50000UL >> BMP_OSS);
+  int32_t p = (b7 < 0x80000000) ? (int32_t)((b7 * 2) / b4) : (int32_t)((b7 / b4) * 2);
+  x1 = (p >> 8) * (p >> 8);
+  x1 = (x1 * 3038) >> 16;
+  x2 = (-7357 * p) >> 16;
+  _pres = (float)(p + ((x1 + x2 + 3791) >> 4));
+  finish(d, now);
+}
+
+/**************************************************************************************************
+stepBH(): BH1750 in continuous mode: read once a new measurement is ready (no trigger needed); the
+         library gives a negative level for a failed read
+parameters: d: i2cDev&: state, bh: BH1750&: the sensor, lux: float&: where the reading goes,
+            now: unsigned long: millis()
+returns: void
+***************************************************************************************************/
+void I2CSensors::stepBH(i2cDev& d, BH1750& bh, float& lux, unsigned long now) {
+  int dev = (&d == &_dev[DEV_BHA]) ? DEV_BHA : DEV_BHB;
+  if (d.state == ST_IDLE) {
+    if ((now - d.tLast < _period) && (d.reads > 0)) return;
+    start(d, now, ST_CONV, 0);
+  }
+  if (bh.measurementReady()) {
+    float op = bh.readLightLevel();
+    if (op < 0.0f) {
+      fail(dev, now);
+      return;
+    }
+    lux = op;
+    finish(d, now);
+  } else if (now - d.tStart > d.timeout) {
+    d.timeouts++;
+    fail(dev, now);
+  }
+}
+
+/**************************************************************************************************
+command(): writes bytes to a device in one transaction
+parameters: addr: uint8_t: I2C address, bytes: const uint8_t*, len: int
+returns: bool: true if the device acknowledged
+***************************************************************************************************/
+bool I2CSensors::command(uint8_t addr, const uint8_t* bytes, int len) {
+  Wire.beginTransmission(addr);
+  for (int i = 0; i < len; i++) Wire.write(bytes[i]);
+  return Wire.endTransmission() == 0;
+}
+
+/**************************************************************************************************
+readRegs(): reads len consecutive registers from reg onwards
+parameters: addr: uint8_t, reg: uint8_t, buf: uint8_t*: receives the bytes, len: int
+returns: bool: true if all bytes were read
+***************************************************************************************************/
+bool I2CSensors::readRegs(uint8_t addr, uint8_t reg, uint8_t* buf, int len) {
+  if (!command(addr, &reg, 1)) return false;
+  if (Wire.requestFrom(addr, (uint8_t)len) != len) return false;
+  for (int i = 0; i < len; i++) buf[i] = Wire.read();
+  return true;
+}
+
+/**************************************************************************************************
+readCalibration(): reads the BMP180's 11 calibration words (0xAA to 0xBF, big-endian)
+parameters: none
+returns: bool: true if read
+***************************************************************************************************/
+bool I2CSensors::readCalibration() {
+  uint8_t b[22];
+  if (!readRegs(BMP_ADDR, 0xAA, b, 22)) return false;
+  _ac1 = (int16_t)((b[0] << 8) | b[1]);
+  _ac2 = (int16_t)((b[2] << 8) | b[3]);
+  _ac3 = (int16_t)((b[4] << 8) | b[5]);
+  _ac4 = (uint16_t)((b[6] << 8) | b[7]);
+  _ac5 = (uint16_t)((b[8] << 8) | b[9]);
+  _ac6 = (uint16_t)((b[10] << 8) | b[11]);
+  _b1 = (int16_t)((b[12] << 8) | b[13]);
+  _b2 = (int16_t)((b[14] << 8) | b[15]);
+  _mb = (int16_t)((b[16] << 8) | b[17]);
+  _mc = (int16_t)((b[18] << 8) | b[19]);
+  _md = (int16_t)((b[20] << 8) | b[21]);
+  return true;
+}
@@ -0,0 +1,108 @@
+#ifndef I2C_SENSORS_H
+#define I2C_SENSORS_H
+#include "Config.h"
+
+#include <Wire.h>
+#include <Adafruit_BMP085_U.h>
+#include <Adafruit_AHTX0.h>
+#include <BH1750.h>
+
+/***********************************************************************************************
+* I2CSensors.h: header file for I2CSensors class: non-blocking reads of the AHT20, BMP180      *
+*               and both BH1750s, with each device's health looked after                       *
+*                                                                                              *
+* Version: 0.1                                                                                 *
+* Last updated: 17/10/2026                                                                     *
+* Author: Jim Gunther                                                                          *
+*                                                                                              *
+* A device is down after I2C_FAILS failures in a row (timeouts, NACKs, error readings) and its *
+* begin() is tried again with exponential backoff until it answers. A bus held stuck by a      *
+* device mid-transfer is cleared by clocking SCL and starting Wire again. Each change is kept  *
+* for getNews(), so the sampling task can post it.                                             *
+***********************************************************************************************/
+
+// Device indexes (bit n of the status word is set while device n is down)
+#define DEV_BMP 0
+#define DEV_AHT 1
+#define DEV_BHA 2
+#define DEV_BHB 3
+#define NUM_DEVS 4
+
+// Acquisition states
+#define ST_IDLE 0
+#define ST_CONV 1   // conversion started: waiting for its time budget
+#define ST_CONV2 2  // BMP180 only: pressure conversion after temperature
+
+struct i2cDev {
+  int state;
+  unsigned long tStart;   // when the current conversion was triggered
+  unsigned long tLast;    // when the last good reading arrived
+  unsigned long budget;   // ms to leave the device alone after triggering
+  unsigned long timeout;  // ms after triggering to give up
+  uint32_t reads;
+  uint32_t timeouts;
+  uint8_t fails;          // failures in a row
+  unsigned long retryAt;  // down: when to try begin() again ...
+  unsigned long backoff;  // ... and the wait after that if it fails
+  uint16_t tries;         // down: begin() attempts so far
+  uint8_t news;           // NEWS_ change not yet collected by getNews()
+};
+
+// Health changes waiting for getNews()
+#define NEWS_NONE 0
+#define NEWS_DOWN 1
+#define NEWS_UP 2
+
+class I2CSensors {
+  public:
+    I2CSensors();
+    uint begin();
+    void tick(unsigned long now);
+    bool isFresh(int dev, unsigned long now);
+    void setPeriod(unsigned long ms) { _period = ms; }  // how often each sensor is read
+    uint status() { return _status; }
+    bool getNews(char* buf, int len);
+    float temperature() { return _temp; }
+    float humidity() { return _hum; }
+    float pressure() { return _pres; }  // Pa
+    float lightA() { return _luxA; }
+    float lightB() { return _luxB; }
+
+  private:
+    void stepAHT(i2cDev& d, unsigned long now);
+    void stepBMP(i2cDev& d, unsigned long now);
+    void stepBH(i2cDev& d, BH1750& bh, float& lux, unsigned long now);
+    bool command(uint8_t addr, const uint8_t* bytes, int len);
+    bool readRegs(uint8_t addr, uint8_t reg, uint8_t* buf, int len);
+    bool readCalibration();
+    void start(i2cDev& d, unsigned long now, int state, unsigned long budget);
+    void finish(i2cDev& d, unsigned long now);
+    void fail(int dev, unsigned long now);
+    bool startDev(int dev);
+    void retry(unsigned long now);
+    void recoverBus(unsigned long now);
+
+    // Library objects: only used for detection and set-up in begin()
+    Adafruit_AHTX0 _aht;
+    Adafruit_BMP085_Unified _bmp;
+    BH1750 _bh1750a;
+    BH1750 _bh1750b;
+
+    i2cDev _dev[NUM_DEVS];
+    uint _status;
+    unsigned long _recoveredAt;  // last bus recovery (0: none yet)
+    uint16_t _recoveries;
+    bool _busNews;
+    unsigned long _period;
+    float _temp;
+    float _hum;
+    float _pres;
+    float _luxA;
+    float _luxB;
+
+    // BMP180 calibration coefficients (datasheet names) and last raw temperature
+    int16_t _ac1, _ac2, _ac3, _b1, _b2, _mb, _mc, _md;
+    uint16_t _ac4, _ac5, _ac6;
+    int32_t _ut;
+};
+#endif
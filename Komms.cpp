@@ -1,5 +1,6 @@
 #include "Komms.h"
 #include "Arduino.h"
+#include <stddef.h>
 
 /*
 **************************************************************************
@@ -12,6 +13,10 @@
 * Change History                                                         *
 *                                                                        *
 *	14/03/2025	0.2 - > 0.3	RDG		Added RED led blink on WiFi              *                                                                        *
+*	17/10/2026	0.3 - > 0.4	JG		checkWifi() reconnects, no reboot         *
+*	17/10/2026	0.4 - > 0.5	JG		warm start; no fixed delays               *
+*	17/10/2026	0.5 - > 0.6	JG		no String temporaries (SSID, IP)          *
+*	17/10/2026	0.6 - > 0.7	JG		warm start stays on DHCP                  *
 *                                                                        *
 **************************************************************************
  */
@@ -19,22 +24,31 @@
 // class Komms: responsible for wifi communications
 // Also reads stored Wifi login credentials
 
-Komms::Komms() {};  // empty constructor
+#define WARM_MAGIC 0x57524D32UL  // changes with the warmCache layout
+
+static RTC_NOINIT_ATTR warmCache _cache;
+
+Komms::Komms() {
+  _lostAt = 0;
+  _warm = false;
+  _connectMs = 0;
+};
 
 /*****************************************************************************************************
-begin(): initiation code for Komms object: connects to Wifi
+begin(): initiation code for Komms object: connects to Wifi, straight to the last access point if
+the warm cache is good, otherwise by scanning
 parameters: none
 returns: void
 ******************************************************************************************************/
 void Komms::begin() {
   // Set WiFi to station mode and disconnect from an AP if it was previously connected.
 
-  int WiFi_count;
-  delay(300);
+  int WiFi_count = 0;
+  unsigned long t0 = millis();
   WiFi.mode(WIFI_STA);
-  WiFi.disconnect();
   readCredentials();  // gets all networks' router credentials
-  if (!connectToWiFi()) {
+  _warm = warmConnect();
+  if (!_warm && !connectToWiFi()) {
     _status = 1;
     Serial.println("WiFi connection failed.");
 
@@ -47,7 +61,70 @@ void Komms::begin() {
     }
     esp_restart();
   }
-  delay( 1000 );
+  saveCache();
+  _connectMs = millis() - t0;
+}
+
+/*****************************************************************************************************
+warmConnect(): connects with the cached network, BSSID and channel (no scan); the address comes from DHCP
+              as usual, never from a lease that may have run out
+parameters: none
+returns: bool: true if connected within WARM_WAIT; on failure the cache is dropped
+******************************************************************************************************/
+bool Komms::warmConnect() {
+  if ((_cache.magic != WARM_MAGIC) || (_cache.check != cacheCheck())) return false;
+  if ((_cache.nwkIx < 0) || (_cache.nwkIx >= NUM_NETWORKS)) return false;
+  _nwkIx = _cache.nwkIx;
+  strcpy(_ssidChosen, _ssid[_nwkIx]);
+  unScram(_pwd[_nwkIx], _pwdChosen);
+  WiFi.begin(_ssidChosen, _pwdChosen, _cache.channel, _cache.bssid);
+  unsigned long t0 = millis();
+  while ((WiFi.status() != WL_CONNECTED) && (millis() - t0 < WARM_WAIT)) delay(10);
+  if (WiFi.status() == WL_CONNECTED) {
+    setIP();
+    return true;
+  }
+  _cache.magic = 0;
+  WiFi.disconnect();
+  return false;
+}
+
+/*****************************************************************************************************
+saveCache(): records the connection just made for the next warm start (keeps the cached rptIntvl)
+parameters: none
+returns: void
+******************************************************************************************************/
+void Komms::saveCache() {
+  int rpt = getRptIntvl();
+  _cache.magic = WARM_MAGIC;
+  _cache.nwkIx = _nwkIx;
+  memcpy(_cache.bssid, WiFi.BSSID(), 6);
+  _cache.channel = WiFi.channel();
+  _cache.rptIntvl = rpt;
+  _cache.check = cacheCheck();
+}
+
+/*****************************************************************************************************
+getRptIntvl(): the report interval the Shed last sent, from the warm cache
+parameters: none
+returns: int: loops, or 0 if there is none
+******************************************************************************************************/
+int Komms::getRptIntvl() {
+  if ((_cache.magic != WARM_MAGIC) || (_cache.check != cacheCheck())) return 0;
+  return _cache.rptIntvl;
+}
+
+void Komms::saveRptIntvl(int rptIntvl) {
+  if (_cache.magic != WARM_MAGIC) return;
+  _cache.rptIntvl = rptIntvl;
+  _cache.check = cacheCheck();
+}
+
+uint32_t Komms::cacheCheck() {
+  const uint8_t* p = (const uint8_t*)&_cache;
+  uint32_t sum = 0x5A5A5A5AUL;
+  for (size_t i = 0; i < offsetof(warmCache, check); i++) sum = (sum << 5) + (sum >> 27) + p[i];
+  return sum;
 }
 /*******************************************************************************************
 unScram: algorithm to unscramble string buffer contents
@@ -69,7 +146,7 @@ void Komms::unScram(const char* src, char* dest) {
 connectToWiFi(): scans wifi networks and choose a match with Shed or Home
 parameters: none
 Returns: boolean: true if successful
-/*********************************************************************************************************/
+**********************************************************************************************************/
 bool Komms::connectToWiFi() {
   WiFi.mode(WIFI_STA);
   Serial.print("WiFi Connecting...");
@@ -80,13 +157,15 @@ bool Komms::connectToWiFi() {
     int i, j;
     for (i = 0; i < nn; i++) {
       for (j = 0; j < NUM_NETWORKS; j++) {
-        if (strcmp(WiFi.SSID(i).c_str(), _ssid[j]) == 0) {
+        wifi_ap_record_t* ap = (wifi_ap_record_t*)WiFi.getScanInfoByIndex(i);  // WiFi.SSID(i) makes a String
+        if ((ap != NULL) && (strcmp((const char*)ap->ssid, _ssid[j]) == 0)) {
           strcpy(_ssidChosen, _ssid[j]);
           unScram(_pwd[j], _pwdChosen);
           _nwkIx = j;
         }
       }
     }
+    WiFi.scanDelete();  // frees the scan results
   } else {
     return false;
   }
@@ -96,15 +175,26 @@ bool Komms::connectToWiFi() {
   WiFi.disconnect();
   WiFi.begin(_ssidChosen, _pwdChosen);
   WiFi.waitForConnectResult();
-  while ((WiFi.status() != WL_CONNECTED) || numTries++ < 5) {
+  while ((WiFi.status() != WL_CONNECTED) && (numTries++ < 5)) {
     delay(1000);
   }
+  if (WiFi.status() != WL_CONNECTED) return false;
   Serial.print("WiFi connected. IP Address: ");
-  strcpy(_ipAddress, WiFi.localIP().toString().c_str());
+  setIP();
   Serial.println(_ipAddress); // this is IP address for HUB, NOT MQTT server!
   return true;
 }
 
+/*****************************************************************************************************
+setIP(): keeps the IP address as text, without WiFi.localIP().toString()'s String
+parameters: none
+returns: void
+*****************************************************************************************************/
+void Komms::setIP() {
+  IPAddress ip = WiFi.localIP();
+  snprintf(_ipAddress, IP_LEN, "%u.%u.%u.%u", ip[0], ip[1], ip[2], ip[3]);
+}
+
 /*****************************************************************************************************
 getNwkIx();: gets the index number (0-2) of which Wifi network kad been found (shed, Jim, Richard)
 parameters: none
@@ -128,16 +218,20 @@ bool Komms::readCredentials() {
 }
 
 /*****************************************************************************************************
-checkWifi(): checks if wfi is still reconnected and reboots the ESP if not
+checkWifi(): checks if wifi is still connected and asks it to reconnect if not. Only reboots the
+ESP after WIFI_GIVEUP without a connection: reports not posted meanwhile are kept in the record log.
 parameters: none
 returns bool: true if still connected
 *****************************************************************************************************/
 bool Komms::checkWifi() {
   bool ok = WiFi.status() == WL_CONNECTED;
-  if (!ok) 
-  {
-    digitalWrite( RedPin, ON );
-    esp_restart();
-  } 
-  return true;
-}
+  if (ok) {
+    _lostAt = 0;
+    return true;
+  }
+  digitalWrite( RedPin, ON );
+  if (_lostAt == 0) _lostAt = millis() | 1;
+  WiFi.reconnect();
+  if (millis() - _lostAt > WIFI_GIVEUP) esp_restart();
+  return false;
+}
\ No newline at end of file
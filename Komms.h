@@ -12,6 +12,18 @@
 * Author: Jim Gunther                                                                          *
 *                                                                                              *
 ***********************************************************************************************/
+
+// Last good connection, kept in RTC memory through software restarts (daily reboot, Wi-Fi give-up)
+// so the next start can go straight to the access point: no scan. The address still comes from DHCP,
+// so the lease is always a live one
+struct warmCache {
+  uint32_t magic;
+  int nwkIx;
+  uint8_t bssid[6];
+  int channel;
+  int rptIntvl;    // 0 until the Shed has sent one
+  uint32_t check;  // sum of the fields above: RTC memory is random after power-up
+};
     
 class Komms {
   
@@ -20,17 +32,28 @@ class Komms {
   void begin();
   int getNwkIx();
   bool checkWifi();
+  bool isWarm() { return _warm; }
+  unsigned long connectMs() { return _connectMs; }
+  int getRptIntvl();
+  void saveRptIntvl(int rptIntvl);
   
   private:
   void unScram(const char *src, char * dest);  
   bool readCredentials(); // gets "menu" of wifi networks from code
   bool connectToWiFi();
+  bool warmConnect();
+  void saveCache();
+  uint32_t cacheCheck();
+  void setIP();
   const char* getIP() { return _ipAddress; }
   
   //unsigned int icLength;
   //char _mqttServer[IP_LEN];
   int _status;
   int _nwkIx;
+  unsigned long _lostAt;  // millis() when Wi-Fi was found to be down (0 if up)
+  bool _warm;             // connected from the warm cache
+  unsigned long _connectMs;
   
   char _ssid[NUM_NETWORKS][SSID_LEN];
   char _pwd[NUM_NETWORKS][PWD_LEN];
@@ -0,0 +1,79 @@
+#include "MemWatch.h"
+#include <stdio.h>
+
+/***********************************************************************************************
+* MemWatch.cpp: MemWatch class: samples heap and stack headroom for TOPIC_HEALTH               *
+*                                                                                              *
+* Version: 0.1                                                                                 *
+* Last updated: 17/10/2026                                                                     *
+* Author: Jim Gunther                                                                          *
+*                                                                                              *
+* Network task only. The stack figures are FreeRTOS high-water marks: the least the task has   *
+* ever had spare, so they only go down.                                                        *
+***********************************************************************************************/
+
+static const char* taskNames[NUM_WATCHED] = { "sample", "net", "ota" };
+
+MemWatch::MemWatch() {
+  for (int i = 0; i < NUM_WATCHED; i++) {
+    _task[i] = NULL;
+    _stack[i] = 0;
+  }
+  _free = _largest = _minFree = 0;
+  _base = 0;
+};
+
+/*******************************************************************************************
+sample(): reads the heap and each watched task's stack high-water mark
+parameters: none
+returns: void
+********************************************************************************************/
+void MemWatch::sample() {
+  _free = ESP.getFreeHeap();
+  _largest = ESP.getMaxAllocHeap();
+  _minFree = ESP.getMinFreeHeap();
+  if (_base == 0) _base = _free;
+  for (int i = 0; i < NUM_WATCHED; i++) {
+    if (_task[i] != NULL) _stack[i] = uxTaskGetStackHighWaterMark(_task[i]);
+  }
+}
+
+/*******************************************************************************************
+getCSV(): the last sample: ",<free>,<largest>,<min free>,<drift>" then ",<task>,<stack spare>"
+          for each watched task (bytes; drift is heap lost since the baseline, negative if gained)
+parameters: buf: char*: receives the text, len: int: its size
+returns: int: characters written
+********************************************************************************************/
+int MemWatch::getCSV(char* buf, int len) {
+  int n = snprintf(buf, len, ",%u,%u,%u,%ld", (unsigned)_free, (unsigned)_largest, (unsigned)_minFree,
+                   (long)_base - (long)_free);
+  for (int i = 0; (i < NUM_WATCHED) && (n < len); i++) {
+    n += snprintf(buf + n, len - n, ",%s,%u", taskNames[i], (unsigned)_stack[i]);
+  }
+  return (n < len) ? n : len - 1;
+}
+
+/*******************************************************************************************
+rebootDue(): checks the last sample against the MEM_ limits
+parameters: why: char*: receives the reason if a reboot is due, len: int: its size
+returns: bool: true if headroom has run low enough to reboot
+********************************************************************************************/
+bool MemWatch::rebootDue(char* why, int len) {
+  if (_base == 0) return false;
+  if (_free < MEM_MIN_FREE) {
+    snprintf(why, len, "free heap %u", (unsigned)_free);
+  } else if (_largest < MEM_MIN_BLOCK) {
+    snprintf(why, len, "largest block %u", (unsigned)_largest);
+  } else if ((long)_base - (long)_free > MEM_MAX_DRIFT) {
+    snprintf(why, len, "heap drift %ld", (long)_base - (long)_free);
+  } else {
+    for (int i = 0; i < NUM_WATCHED; i++) {
+      if ((_task[i] != NULL) && (_stack[i] < MEM_MIN_STACK)) {
+        snprintf(why, len, "%s stack %u", taskNames[i], (unsigned)_stack[i]);
+        return true;
+      }
+    }
+    return false;
+  }
+  return true;
+}
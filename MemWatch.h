@@ -0,0 +1,42 @@
+#ifndef MEM_WATCH_H
+#define MEM_WATCH_H
+#include <stdint.h>
+#include "Arduino.h"
+#include "Config.h"
+
+/***********************************************************************************************
+* MemWatch.h: header file for MemWatch class: heap and task stack headroom, and whether it is  *
+*             time to reboot                                                                   *
+*                                                                                              *
+* Version: 0.1                                                                                 *
+* Last updated: 17/10/2026                                                                     *
+* Author: Jim Gunther                                                                          *
+*                                                                                              *
+* Once running, nothing in the sketch allocates: queues, buffers and the outbox are all fixed  *
+* size. The first sample() after setup is the steady-state baseline, so heap lost since then   *
+* (the drift) shows any allocation that is never given back, ours or a library's. A reboot is  *
+* wanted only when headroom actually runs low (MEM_ limits in Config.h), not every midnight.   *
+***********************************************************************************************/
+
+#define MW_SAMPLE 0  // watched tasks
+#define MW_NET 1
+#define MW_OTA 2
+#define NUM_WATCHED 3
+
+class MemWatch {
+  public:
+    MemWatch();
+    void watch(int ix, TaskHandle_t task) { _task[ix] = task; }
+    void sample();
+    int getCSV(char* buf, int len);
+    bool rebootDue(char* why, int len);
+
+  private:
+    TaskHandle_t _task[NUM_WATCHED];
+    uint32_t _free;     // free heap now (bytes)
+    uint32_t _largest;  // largest block that could be allocated now
+    uint32_t _minFree;  // least free heap since boot
+    uint32_t _base;     // free heap at the first sample (0 before it)
+    uint32_t _stack[NUM_WATCHED];  // least stack each task has had spare since it started (bytes)
+};
+#endif
@@ -0,0 +1,109 @@
+#include "MqttLink.h"
+
+/***********************************************************************************************
+* MqttLink.cpp: MqttLink class: MQTT connection upkeep with jittered exponential backoff; at   *
+*               most one connect attempt per tick and no waiting between attempts              *
+*                                                                                              *
+* Version: 0.1                                                                                 *
+* Last updated: 17/10/2026                                                                     *
+* Author: Jim Gunther                                                                          *
+*                                                                                              *
+* PubSubClient's connect() is synchronous: the TCP connect and the wait for CONNACK are kept   *
+* short by the client's timeouts (MQTT_CONNECT_MS, MQTT_SOCK_SECS), set up in qtSetup().       *
+***********************************************************************************************/
+
+MqttLink::MqttLink(PubSubClient& client) : _client(client) {
+  _clientId = "";
+  _onUp = _onDown = nullptr;
+  _state = LINK_DOWN;
+  _changedAt = _downMs = _nextTry = 0;
+  _backoff = MQTT_BACKOFF_MIN;
+  _tries = 0;
+  _pubFails = 0;
+};
+
+/*******************************************************************************************
+begin(): sets the client id and callbacks; the first connect is tried on the next tick
+parameters: clientId: const char*, onUp, onDown: void (*)(): called when the link comes up or
+            goes down (may be nullptr)
+returns: void
+********************************************************************************************/
+void MqttLink::begin(const char* clientId, void (*onUp)(), void (*onDown)()) {
+  _clientId = clientId;
+  _onUp = onUp;
+  _onDown = onDown;
+  _client.setKeepAlive(MQTT_KEEPALIVE);
+  _client.setSocketTimeout(MQTT_SOCK_SECS);
+  _state = LINK_DOWN;
+  _changedAt = _nextTry = millis();
+  _backoff = MQTT_BACKOFF_MIN;
+  _tries = 0;
+}
+
+/*******************************************************************************************
+tick(): one step: services the client while up, or tries to connect once the backoff is over
+parameters: now: unsigned long: millis()
+returns: void
+********************************************************************************************/
+void MqttLink::tick(unsigned long now) {
+  if (_state == LINK_UP) {
+    if (!_client.loop()) goDown(now);  // false once the library has seen the connection drop
+    return;
+  }
+  if ((long)(now - _nextTry) >= 0) attempt(now);
+}
+
+/*******************************************************************************************
+published(): publishers report each outcome; a run of failures means the link is dead even if
+             the library has not noticed yet
+parameters: ok: bool: the publish went out
+returns: void
+********************************************************************************************/
+void MqttLink::published(bool ok) {
+  if (ok) {
+    _pubFails = 0;
+  } else if ((_state == LINK_UP) && (++_pubFails >= MQTT_PUB_FAILS)) {
+    goDown(millis());
+  }
+}
+
+/*******************************************************************************************
+attempt(): one connect attempt; on failure the next is scheduled at between half and all of
+           the backoff, which then doubles
+parameters: now: unsigned long: millis()
+returns: void
+********************************************************************************************/
+void MqttLink::attempt(unsigned long now) {
+  if (WiFi.status() != WL_CONNECTED) {  // Komms is dealing with it: look again shortly
+    _nextTry = now + MQTT_BACKOFF_MIN;
+    return;
+  }
+  _tries++;
+  if (_client.connect(_clientId)) {
+    _state = LINK_UP;
+    _downMs = millis() - _changedAt;
+    _changedAt = millis();
+    _backoff = MQTT_BACKOFF_MIN;
+    _pubFails = 0;
+    if (_onUp) _onUp();
+    return;
+  }
+  now = millis();  // the attempt itself takes time
+  _nextTry = now + _backoff / 2 + esp_random() % (_backoff / 2 + 1);
+  _backoff = min(2 * _backoff, (unsigned long)MQTT_BACKOFF_MAX);
+}
+
+/*******************************************************************************************
+goDown(): drops the connection and starts the backoff again from MQTT_BACKOFF_MIN
+parameters: now: unsigned long: millis()
+returns: void
+********************************************************************************************/
+void MqttLink::goDown(unsigned long now) {
+  _client.disconnect();
+  _state = LINK_DOWN;
+  _changedAt = now;
+  _tries = 0;
+  _backoff = MQTT_BACKOFF_MIN;
+  _nextTry = now + esp_random() % (MQTT_BACKOFF_MIN + 1);
+  if (_onDown) _onDown();
+}
@@ -0,0 +1,52 @@
+#ifndef MQTT_LINK_H
+#define MQTT_LINK_H
+#include <WiFi.h>
+#include <PubSubClient.h>
+#include "Config.h"
+
+/***********************************************************************************************
+* MqttLink.h: header file for MqttLink class: the MQTT connection as a state machine, run from *
+*             the network task one short step at a time                                        *
+*                                                                                              *
+* Version: 0.1                                                                                 *
+* Last updated: 17/10/2026                                                                     *
+* Author: Jim Gunther                                                                          *
+*                                                                                              *
+* LINK_DOWN: a connect is tried when the backoff has run out (and Wi-Fi is up); each failure   *
+*            doubles the backoff, MQTT_BACKOFF_MIN to MQTT_BACKOFF_MAX, with random jitter     *
+* LINK_UP:   client.loop() each tick; the library's keepalive pings find a dead broker, and    *
+*            MQTT_PUB_FAILS publishes failing in a row drop the link too                       *
+* onUp() and onDown() are called on each change, so publishers can switch between sending and  *
+* queueing (record log, message queue) without trying and failing first.                       *
+***********************************************************************************************/
+
+#define LINK_DOWN 0
+#define LINK_UP 1
+
+class MqttLink {
+  public:
+    MqttLink(PubSubClient& client);
+    void begin(const char* clientId, void (*onUp)(), void (*onDown)());
+    void tick(unsigned long now);
+    void published(bool ok);
+    bool isUp() { return _state == LINK_UP; }
+    uint32_t getTries() { return _tries; }
+    unsigned long getDownMs() { return _downMs; }
+
+  private:
+    void attempt(unsigned long now);
+    void goDown(unsigned long now);
+
+    PubSubClient& _client;
+    const char* _clientId;
+    void (*_onUp)();
+    void (*_onDown)();
+    int _state;
+    unsigned long _changedAt;  // millis() at the last change of state
+    unsigned long _downMs;     // how long the last outage lasted
+    unsigned long _nextTry;    // millis() of the next connect attempt
+    unsigned long _backoff;    // current backoff before jitter
+    uint32_t _tries;           // connect attempts in the current (or last) outage
+    int _pubFails;             // publishes failed in a row
+};
+#endif
@@ -0,0 +1,120 @@
+#ifndef OTA_PAGE_H
+#define OTA_PAGE_H
+#include <stdint.h>
+
+/***********************************************************************************************
+* OtaPage.h: the firmware update page (OtaPage.html), gzipped: served as it is, with           *
+*            Content-Encoding: gzip. Made from OtaPage.html: do not edit by hand.              *
+*                                                                                              *
+* Version: 0.1                                                                                 *
+* Last updated: 17/10/2026                                                                     *
+* Author: Jim Gunther                                                                          *
+*                                                                                              *
+***********************************************************************************************/
+static const uint8_t otaPageGz[] PROGMEM = {
+  0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x85, 0x56,
+  0x6d, 0x6f, 0xdb, 0x38, 0x0c, 0xfe, 0x9e, 0x5f, 0xa1, 0x05, 0xdb, 0x6c,
+  0xd5, 0x2f, 0xb1, 0x9d, 0x34, 0x4d, 0x6b, 0xcb, 0xc3, 0xd6, 0xbd, 0x74,
+  0x58, 0x8b, 0x16, 0xdd, 0x86, 0xdd, 0x21, 0x70, 0x0f, 0x8a, 0x2d, 0xd7,
+  0x4a, 0x1d, 0xd9, 0xb3, 0xe5, 0x24, 0x5d, 0x9b, 0xfb, 0xed, 0x47, 0xd9,
+  0x49, 0xda, 0x3b, 0x0c, 0xb8, 0x7c, 0x30, 0x48, 0x8a, 0x7c, 0x44, 0x3e,
+  0x92, 0xc8, 0x04, 0x2f, 0xde, 0x5f, 0x9e, 0x7e, 0xfb, 0xf3, 0xea, 0x03,
+  0xca, 0xe4, 0x22, 0x0f, 0x7b, 0xc1, 0x0b, 0xcb, 0x42, 0xd7, 0x45, 0x91,
+  0x8e, 0x50, 0xca, 0xab, 0xc5, 0x8a, 0x56, 0x0c, 0x35, 0x65, 0x42, 0x25,
+  0x43, 0x25, 0xbd, 0x65, 0x36, 0xba, 0x94, 0xf4, 0x4a, 0x09, 0x19, 0xca,
+  0x8a, 0x3c, 0xa9, 0x11, 0x97, 0xe8, 0xf6, 0x17, 0x2f, 0x4b, 0x96, 0x9c,
+  0x20, 0x9a, 0x4a, 0x56, 0x21, 0x96, 0x70, 0xc9, 0xc5, 0xad, 0x89, 0x2a,
+  0xb6, 0xa0, 0x77, 0x0c, 0xc9, 0x8c, 0x21, 0x5a, 0x55, 0xf4, 0x5e, 0x49,
+  0x00, 0xb7, 0xe2, 0x32, 0xeb, 0x21, 0xf5, 0xd3, 0x59, 0x9c, 0x15, 0x48,
+  0xab, 0x25, 0x95, 0x3c, 0x46, 0x71, 0x21, 0x6a, 0x89, 0x1a, 0x2e, 0xe4,
+  0xe4, 0x2f, 0x89, 0x8a, 0x6e, 0x9f, 0x4f, 0xbf, 0xa6, 0x11, 0xba, 0xba,
+  0xbe, 0xfc, 0x74, 0xf1, 0xe1, 0x02, 0x11, 0xf4, 0xa0, 0xf9, 0xed, 0x76,
+  0xc8, 0x3a, 0x16, 0x28, 0x78, 0x4a, 0x06, 0x72, 0x47, 0x8f, 0x68, 0xbd,
+  0x4e, 0x90, 0xc5, 0x7d, 0xd4, 0xc1, 0x6e, 0x7c, 0x0d, 0x23, 0xcb, 0x82,
+  0x9a, 0xda, 0xd2, 0x82, 0x8c, 0xd1, 0x24, 0x0c, 0x16, 0x4c, 0x52, 0x14,
+  0x67, 0xb4, 0xaa, 0x99, 0x24, 0xfd, 0x46, 0xa6, 0xd6, 0xa4, 0xbf, 0xb5,
+  0x0a, 0xba, 0x60, 0xa4, 0xbf, 0xe4, 0x6c, 0x55, 0x16, 0x95, 0xec, 0xab,
+  0x84, 0x24, 0x13, 0xe0, 0xb5, 0xe2, 0x89, 0xcc, 0x48, 0xc2, 0x96, 0x3c,
+  0x66, 0x56, 0xab, 0x40, 0x88, 0xe4, 0x32, 0x67, 0x61, 0x47, 0x55, 0xc7,
+  0x50, 0x30, 0xe8, 0x6c, 0xc1, 0xa0, 0xdd, 0xaa, 0x17, 0xcc, 0x8a, 0xe4,
+  0x1e, 0xd5, 0xf2, 0x3e, 0x07, 0xd8, 0x14, 0xc0, 0xac, 0x94, 0x2e, 0x78,
+  0x7e, 0x7f, 0x52, 0x53, 0x51, 0x5b, 0x35, 0xab, 0x78, 0xda, 0x57, 0xd9,
+  0x0d, 0xc3, 0xdf, 0x12, 0x0e, 0x30, 0x43, 0x58, 0xe6, 0xa2, 0x6c, 0x24,
+  0x92, 0xf7, 0xa5, 0x02, 0xe1, 0x39, 0xeb, 0x23, 0x9e, 0x80, 0xd4, 0x47,
+  0x34, 0x8e, 0x59, 0x09, 0xd9, 0xd9, 0x33, 0x2e, 0xfa, 0x21, 0x0a, 0x66,
+  0x8d, 0x94, 0x85, 0x68, 0x57, 0x67, 0xfd, 0xf0, 0xfb, 0x16, 0xa3, 0xb3,
+  0x02, 0x4e, 0xd9, 0xae, 0xd4, 0x90, 0xf9, 0xa0, 0x04, 0xb5, 0x8e, 0x2b,
+  0x5e, 0xca, 0xb0, 0x97, 0x36, 0x22, 0x96, 0x1c, 0xe2, 0xea, 0x8c, 0x7a,
+  0x87, 0x63, 0x7d, 0x81, 0x1f, 0x7a, 0x68, 0x49, 0x2b, 0xf4, 0x85, 0x4c,
+  0x23, 0xf3, 0x4c, 0x7d, 0x4a, 0xe2, 0x99, 0x82, 0x38, 0x26, 0x37, 0xe7,
+  0xa6, 0x34, 0x1b, 0xbf, 0x87, 0xf6, 0x41, 0x69, 0xa5, 0xaf, 0xf1, 0x43,
+  0xc5, 0x64, 0x53, 0x09, 0xa4, 0xaf, 0xad, 0x0b, 0x2a, 0x33, 0x3b, 0xcd,
+  0x8b, 0x42, 0xd9, 0xf1, 0xc1, 0xc8, 0x3b, 0x1e, 0x1d, 0x8f, 0x8f, 0xbc,
+  0xe3, 0xf1, 0xa3, 0xb3, 0x81, 0x30, 0x30, 0xfb, 0x22, 0x18, 0x8f, 0xfc,
+  0xd2, 0x30, 0xf0, 0x83, 0x52, 0xe7, 0xc4, 0xf3, 0xe7, 0x07, 0xf3, 0x80,
+  0x94, 0xfe, 0x1c, 0x6c, 0x3c, 0xd5, 0xcb, 0x57, 0x73, 0x42, 0x1c, 0x3c,
+  0xab, 0x18, 0xbd, 0xf3, 0x41, 0x87, 0xd5, 0xb0, 0xc4, 0x0f, 0x20, 0x89,
+  0x60, 0x82, 0xcf, 0xa6, 0x22, 0x22, 0xb0, 0x6b, 0xbb, 0x51, 0xfd, 0xb3,
+  0x92, 0x7a, 0x89, 0xb1, 0xff, 0x65, 0x2a, 0x0c, 0xe3, 0xc9, 0x1e, 0xcf,
+  0x3a, 0xfb, 0x66, 0xd3, 0x95, 0x92, 0x93, 0x85, 0x9d, 0x33, 0x71, 0x2b,
+  0x33, 0xf3, 0x9c, 0xe8, 0xb9, 0x71, 0xe4, 0x85, 0xe1, 0x18, 0x07, 0xc1,
+  0xc8, 0x5c, 0x11, 0xc1, 0x56, 0xe8, 0xb3, 0x90, 0x43, 0xef, 0xad, 0xba,
+  0xa2, 0xfa, 0x39, 0x36, 0x7f, 0xfc, 0xd7, 0x36, 0x1e, 0x61, 0xbf, 0x4b,
+  0x9e, 0x13, 0xc7, 0xe7, 0x41, 0xee, 0x73, 0x48, 0x75, 0x35, 0xe5, 0x61,
+  0xe8, 0x45, 0x8f, 0x64, 0x31, 0xe5, 0x51, 0x10, 0x78, 0x23, 0x6b, 0x72,
+  0xa0, 0xf3, 0xd7, 0x43, 0xe5, 0xbb, 0x9a, 0xe6, 0xdd, 0x9a, 0xeb, 0x4d,
+  0x76, 0x4b, 0xf9, 0x6e, 0xe9, 0xdc, 0x72, 0x23, 0x92, 0x07, 0xc1, 0xd0,
+  0x57, 0xb2, 0x07, 0xf2, 0xe0, 0x70, 0x38, 0x9e, 0x1c, 0x39, 0xc7, 0xae,
+  0xf7, 0xe8, 0x3c, 0x67, 0xf7, 0x5a, 0x5f, 0x9b, 0xf1, 0x9e, 0xde, 0x75,
+  0x18, 0x86, 0xf1, 0xe3, 0x1a, 0x02, 0x3d, 0x2b, 0xde, 0x3c, 0x4f, 0xe8,
+  0x1c, 0x12, 0x22, 0xee, 0x58, 0x9d, 0x5c, 0x5b, 0xef, 0x92, 0x9c, 0xd9,
+  0x75, 0x0e, 0x97, 0x55, 0x57, 0x3b, 0xa2, 0x8e, 0x67, 0xc7, 0x9f, 0x2b,
+  0xe6, 0x15, 0xcb, 0xca, 0x0f, 0xfd, 0x98, 0xce, 0x23, 0x32, 0x0f, 0xdc,
+  0xf1, 0x1b, 0xa8, 0xc4, 0x98, 0x47, 0x27, 0xfa, 0xb5, 0x0e, 0x36, 0x48,
+  0xc8, 0x74, 0x8f, 0xf0, 0xcd, 0x93, 0x72, 0x8c, 0x6f, 0x3a, 0x11, 0xf6,
+  0x77, 0x1d, 0x6c, 0x28, 0xe5, 0x28, 0x32, 0xb6, 0xee, 0xee, 0x61, 0x64,
+  0xee, 0xdd, 0x95, 0xe2, 0x4e, 0x3a, 0x7f, 0x90, 0x21, 0x60, 0xd8, 0xf9,
+  0xbb, 0xe3, 0xa8, 0x2d, 0x0d, 0x21, 0x49, 0x96, 0xd3, 0x2e, 0x7a, 0x39,
+  0x1d, 0x45, 0xe6, 0x58, 0x85, 0xb6, 0x92, 0xeb, 0xee, 0x45, 0xef, 0x10,
+  0x63, 0xa3, 0x15, 0x5f, 0x2f, 0xa7, 0x87, 0xd1, 0xcd, 0xdf, 0x5b, 0x71,
+  0x1c, 0x61, 0xe3, 0x0b, 0xa4, 0xad, 0x20, 0x77, 0x78, 0x0d, 0x69, 0xa1,
+  0x1c, 0x88, 0xea, 0xe2, 0x41, 0x72, 0x87, 0x7b, 0xd1, 0xf3, 0x3a, 0x28,
+  0x47, 0xc5, 0xbb, 0xd1, 0xcd, 0x56, 0xf2, 0x94, 0xe4, 0x76, 0x12, 0xde,
+  0x22, 0x2d, 0xed, 0xb2, 0x28, 0x81, 0xb1, 0xe5, 0x74, 0x18, 0x11, 0xf5,
+  0x31, 0x24, 0xac, 0x2c, 0xed, 0x46, 0xd4, 0x19, 0x4f, 0xa5, 0x2e, 0x8d,
+  0xe6, 0xd1, 0x69, 0x09, 0xdd, 0xfc, 0x8b, 0xd4, 0x49, 0xcb, 0xe9, 0x99,
+  0xa2, 0x53, 0x7d, 0x8c, 0xe5, 0x2e, 0x39, 0x70, 0xdb, 0x1e, 0xdd, 0x99,
+  0xbd, 0xa0, 0xa5, 0xbe, 0x3b, 0xd7, 0xe7, 0x4f, 0x46, 0x73, 0xba, 0x9f,
+  0x66, 0xe8, 0xea, 0x7c, 0x1d, 0x6c, 0xcb, 0xe2, 0xab, 0xac, 0xa0, 0x7f,
+  0xea, 0x70, 0xa0, 0x78, 0x7b, 0x8c, 0xd6, 0x04, 0x6f, 0xb0, 0x3d, 0x2f,
+  0xb8, 0xd0, 0x35, 0x0d, 0x52, 0xd8, 0x3c, 0x3d, 0xdb, 0x97, 0x3a, 0xdf,
+  0xa3, 0x25, 0x45, 0xdc, 0x2c, 0xa0, 0x63, 0xd9, 0xb7, 0x4c, 0x7e, 0xc8,
+  0x99, 0x12, 0xdf, 0xdd, 0x7f, 0x4e, 0xc0, 0x63, 0xd3, 0x7b, 0xa9, 0x6b,
+  0x33, 0x0d, 0xdb, 0x85, 0x88, 0x01, 0xf1, 0x8e, 0xec, 0x73, 0xd9, 0x3d,
+  0xf7, 0x94, 0x80, 0x47, 0x0a, 0x1e, 0xaa, 0xc7, 0xd4, 0xc0, 0x12, 0x14,
+  0x00, 0x6f, 0xee, 0x45, 0x8a, 0x3b, 0x70, 0x50, 0xc1, 0xa1, 0x06, 0x07,
+  0xc9, 0xd6, 0xf2, 0x74, 0xdb, 0x1a, 0xb5, 0xd3, 0x8c, 0xc5, 0x77, 0x90,
+  0xad, 0x6d, 0xdb, 0x9a, 0xba, 0xba, 0x76, 0xdb, 0xe9, 0xdf, 0x35, 0x69,
+  0xca, 0x2a, 0x1d, 0x7c, 0x33, 0x26, 0x9e, 0xea, 0xa6, 0xfb, 0x1b, 0x9a,
+  0xb4, 0x6f, 0xec, 0x63, 0x51, 0x2d, 0xde, 0x53, 0x49, 0x75, 0x6c, 0xae,
+  0x5b, 0xc3, 0x1f, 0x17, 0xe7, 0x67, 0x52, 0x96, 0xd7, 0xec, 0x67, 0xc3,
+  0x6a, 0xd9, 0xdd, 0xde, 0xc4, 0xa6, 0x30, 0x5d, 0x44, 0xa2, 0x6b, 0x5d,
+  0x5b, 0xd4, 0xcc, 0xb4, 0xb5, 0xaf, 0xed, 0xa6, 0xcc, 0x0b, 0x9a, 0x40,
+  0x49, 0x65, 0x55, 0xdc, 0x56, 0xac, 0xae, 0x9f, 0xaa, 0x62, 0x6d, 0xc3,
+  0x60, 0xdb, 0x57, 0x7f, 0x5a, 0x2c, 0xa0, 0x87, 0xd2, 0x59, 0xce, 0xf0,
+  0xef, 0x6a, 0xf8, 0x0a, 0x5f, 0xa4, 0x19, 0x6d, 0xeb, 0xa8, 0x8a, 0x06,
+  0xb6, 0x82, 0x40, 0x40, 0x66, 0xc9, 0x81, 0xeb, 0x38, 0x03, 0x06, 0x47,
+  0x22, 0x69, 0x8e, 0x0d, 0xed, 0x15, 0xcc, 0x94, 0x76, 0xe7, 0x42, 0xa8,
+  0xf5, 0xe7, 0x24, 0xfe, 0x06, 0x57, 0x5f, 0xdb, 0x6a, 0xb2, 0x35, 0x35,
+  0x21, 0x9e, 0xe3, 0xbc, 0xd1, 0xde, 0x17, 0x82, 0x9d, 0x20, 0xed, 0x44,
+  0xfb, 0x48, 0x81, 0x62, 0x18, 0x97, 0x1a, 0x36, 0xd6, 0x36, 0xe4, 0x5d,
+  0xc2, 0xe0, 0x63, 0xdf, 0x20, 0x72, 0x8f, 0xce, 0xaa, 0xaa, 0xa8, 0xfe,
+  0x07, 0x5e, 0x03, 0x41, 0xb0, 0xee, 0x12, 0xe4, 0x45, 0x2d, 0xf7, 0xb9,
+  0x01, 0x59, 0xba, 0x76, 0x75, 0xf9, 0xf5, 0x9b, 0x66, 0x6a, 0x83, 0x8e,
+  0xb3, 0x37, 0xd0, 0xdc, 0x89, 0x66, 0x6c, 0x5b, 0xbc, 0x62, 0xfa, 0xbb,
+  0x1a, 0xb3, 0x5d, 0x7b, 0xa3, 0x18, 0x6f, 0x09, 0xad, 0x15, 0xcd, 0x89,
+  0x52, 0x36, 0xea, 0x92, 0xf9, 0xbd, 0x60, 0xb0, 0x1b, 0x13, 0x30, 0x48,
+  0x60, 0x98, 0xa9, 0xd1, 0xd6, 0xfe, 0x4d, 0xf8, 0x07, 0x3b, 0xe3, 0x04,
+  0x14, 0x37, 0x08, 0x00, 0x00
+};
+#endif
@@ -0,0 +1,242 @@
+#include "OtaServer.h"
+#include "OtaPage.h"
+#include <stdarg.h>
+#include <stdio.h>
+
+/***********************************************************************************************
+* OtaServer.cpp: OtaServer class: serves the update page and writes an uploaded image to flash *
+*                                                                                              *
+* Version: 0.1                                                                                 *
+* Last updated: 17/10/2026                                                                     *
+* Author: Jim Gunther                                                                          *
+*                                                                                              *
+* The web server takes a whole upload inside one handle(), so it has its own task below the    *
+* network task: MQTT carries on and sampling, on the other core, is never waiting on it. Flash *
+* writes stall both cores' caches, so after every OTA_CHUNKS_PER_TICK chunks (about a sector)  *
+* the task sleeps for OTA_TICK. The page hashes the image and sends the SHA-256 with it; the   *
+* image is hashed again as it streams to flash and is only made bootable if the two agree.     *
+* Updates tried and failed are kept over restarts (the one after a good update included).      *
+***********************************************************************************************/
+
+#define OTA_MAGIC 0x4F544131UL
+
+struct otaCounts {
+  uint32_t magic;
+  uint32_t tries;    // uploads started ...
+  uint32_t fails;    // ... and failed
+  uint32_t lastMs;   // how long the last one took
+  uint32_t check;
+};
+
+static RTC_NOINIT_ATTR otaCounts _counts;
+
+static uint32_t countsCheck() {
+  return _counts.magic ^ (_counts.tries * 31) ^ (_counts.fails * 17) ^ _counts.lastMs;
+}
+
+static int hexVal(char c) {
+  if ((c >= '0') && (c <= '9')) return c - '0';
+  if ((c >= 'a') && (c <= 'f')) return c - 'a' + 10;
+  if ((c >= 'A') && (c <= 'F')) return c - 'A' + 10;
+  return -1;
+}
+
+OtaServer::OtaServer() : _server(80) {
+  _state = OTA_IDLE;
+  _bytes = _chunks = 0;
+  _startMs = 0;
+};
+
+/*****************************************************************************************************
+begin(): sets up the page and upload handlers and starts the web server
+parameters: none
+returns: void
+*****************************************************************************************************/
+void OtaServer::begin() {
+  if ((_counts.magic != OTA_MAGIC) || (_counts.check != countsCheck())) {
+    _counts.magic = OTA_MAGIC;
+    _counts.tries = _counts.fails = _counts.lastMs = 0;
+    _counts.check = countsCheck();
+  }
+  _server.on("/", HTTP_GET, [this]() { sendPage(); });
+  _server.on("/update", HTTP_POST, [this]() { finish(); }, [this]() { upload(); });
+  _server.begin();
+}
+
+/*****************************************************************************************************
+handle(): serves whatever the web server has waiting (OTA task only)
+parameters: none
+returns: void
+*****************************************************************************************************/
+void OtaServer::handle() {
+  ZONE_MARK(ZS_OTA, ZT_OTA);
+  _server.handleClient();
+  ZONE_MARK(ZS_OTA, ZT_IDLE);
+}
+
+/*****************************************************************************************************
+getNews(): the next line of update news, if any (network task)
+parameters: buf: char*: receives it, len: int: its size
+returns: bool: true if there was one
+*****************************************************************************************************/
+bool OtaServer::getNews(char* buf, int len) {
+  otaNote n;
+  if (!_news.pop(n)) return false;
+  snprintf(buf, len, "%s", n.txt);
+  return true;
+}
+
+/*****************************************************************************************************
+getCSV(): ",upd,<tried>,<failed>,<last ms>" for TOPIC_HEALTH
+parameters: buf: char*: receives the text, len: int: its size
+returns: int: characters written
+*****************************************************************************************************/
+int OtaServer::getCSV(char* buf, int len) {
+  int n = snprintf(buf, len, ",upd,%u,%u,%u", (unsigned)_counts.tries, (unsigned)_counts.fails,
+                   (unsigned)_counts.lastMs);
+  return (n < len) ? n : len - 1;
+}
+
+void OtaServer::sendPage() {
+  if (!_server.authenticate(OTA_USER, OTA_PASS)) return _server.requestAuthentication();
+  _server.sendHeader("Content-Encoding", "gzip");
+  _server.sendHeader("Connection", "close");
+  _server.send_P(200, "text/html", (const char*)otaPageGz, sizeof(otaPageGz));
+}
+
+/*****************************************************************************************************
+upload(): the web server's upload callback: each chunk of the image as it arrives
+parameters: none
+returns: void
+*****************************************************************************************************/
+void OtaServer::upload() {
+  HTTPUpload& up = _server.upload();
+  switch (up.status) {
+    case UPLOAD_FILE_START:
+      Serial.printf("Update: %s\n", up.filename.c_str());
+      start();
+      break;
+    case UPLOAD_FILE_WRITE:
+      write(up.buf, up.currentSize);
+      break;
+    case UPLOAD_FILE_END:
+      end();
+      break;
+    default:
+      fail("upload aborted");
+      break;
+  }
+}
+
+/*****************************************************************************************************
+finish(): the web server's reply once the upload is over; the restart is left to the network task
+parameters: none
+returns: void
+*****************************************************************************************************/
+void OtaServer::finish() {
+  _server.sendHeader("Connection", "close");
+  if (_state.load() == OTA_DONE) {
+    _server.send(200, "text/plain", "OK: restarting");
+  } else {
+    if (_state.load() == OTA_RUNNING) fail("no image");
+    _server.send(500, "text/plain", "FAIL: see ws/messages");
+  }
+}
+
+/*****************************************************************************************************
+start(): a new upload: checks who it is from and the hash that came with it, and opens the update.
+         A request refused on those checks is not counted as a try (or a failure).
+parameters: none
+returns: void
+*****************************************************************************************************/
+void OtaServer::start() {
+  if (_state.load() == OTA_DONE) return;  // one good image is enough: the restart is coming
+  const char* why = NULL;
+  String hex = _server.arg("sha");
+  const char* h = hex.c_str();
+  if (!_server.authenticate(OTA_USER, OTA_PASS)) {
+    why = "not authorised";
+  } else if (strlen(h) != 64) {
+    why = "no sha256";
+  } else {
+    for (int i = 0; (i < 32) && (why == NULL); i++) {
+      int hi = hexVal(h[2 * i]), lo = hexVal(h[2 * i + 1]);
+      if ((hi < 0) || (lo < 0)) why = "bad sha256";
+      _want[i] = (uint8_t)(hi * 16 + lo);
+    }
+  }
+  if (why != NULL) {
+    note("OTA refused: %s", why);
+    _state = OTA_FAILED;  // write() and end() ignore the rest of it
+    return;
+  }
+  _counts.tries++;
+  _counts.check = countsCheck();
+  _bytes = _chunks = 0;
+  _startMs = millis();
+  _state = OTA_RUNNING;
+  mbedtls_sha256_init(&_sha);
+  if (!Update.begin(UPDATE_SIZE_UNKNOWN)) return fail(Update.errorString());
+  mbedtls_sha256_starts(&_sha, 0);
+}
+
+/*****************************************************************************************************
+write(): hashes a chunk and writes it to flash, pausing after every OTA_CHUNKS_PER_TICK
+parameters: buf: uint8_t*, len: size_t
+returns: void
+*****************************************************************************************************/
+void OtaServer::write(uint8_t* buf, size_t len) {
+  if (_state.load() != OTA_RUNNING) return;
+  mbedtls_sha256_update(&_sha, buf, len);
+  if (Update.write(buf, len) != len) return fail(Update.errorString());
+  _bytes += len;
+  if (++_chunks % OTA_CHUNKS_PER_TICK == 0) {
+    ZONE_MARK(ZS_OTA, ZT_IDLE);
+    vTaskDelay(pdMS_TO_TICKS(OTA_TICK));
+    ZONE_MARK(ZS_OTA, ZT_OTA);
+  }
+}
+
+/*****************************************************************************************************
+end(): the whole image is in: it is made bootable only if its hash is the one the page sent
+parameters: none
+returns: void
+*****************************************************************************************************/
+void OtaServer::end() {
+  if (_state.load() != OTA_RUNNING) return;
+  uint8_t got[32];
+  mbedtls_sha256_finish(&_sha, got);
+  mbedtls_sha256_free(&_sha);
+  if (memcmp(got, _want, sizeof(got)) != 0) return fail("sha256 mismatch");
+  if (!Update.end(true)) return fail(Update.errorString());
+  _counts.lastMs = millis() - _startMs;
+  _counts.check = countsCheck();
+  note("OTA done: %u bytes in %lu ms, sha256 good; restarting", (unsigned)_bytes, millis() - _startMs);
+  _state = OTA_DONE;
+}
+
+/*****************************************************************************************************
+fail(): gives up on this upload; the running firmware carries on
+parameters: why: const char*
+returns: void
+*****************************************************************************************************/
+void OtaServer::fail(const char* why) {
+  if (_state.load() != OTA_RUNNING) return;
+  if (Update.isRunning()) Update.abort();
+  mbedtls_sha256_free(&_sha);
+  _counts.fails++;
+  _counts.lastMs = millis() - _startMs;
+  _counts.check = countsCheck();
+  note("OTA failed: %s after %u bytes, %lu ms", why, (unsigned)_bytes, millis() - _startMs);
+  _state = OTA_FAILED;
+}
+
+void OtaServer::note(const char* fmt, ...) {
+  otaNote n;
+  va_list args;
+  va_start(args, fmt);
+  vsnprintf(n.txt, sizeof(n.txt), fmt, args);
+  va_end(args);
+  Serial.println(n.txt);
+  _news.push(n);
+}
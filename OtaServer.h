@@ -0,0 +1,61 @@
+#ifndef OTA_SERVER_H
+#define OTA_SERVER_H
+#include <stdint.h>
+#include <atomic>
+#include "Arduino.h"
+#include <WebServer.h>
+#include <Update.h>
+#include <mbedtls/sha256.h>
+#include "Config.h"
+#include "Ring.h"
+
+/***********************************************************************************************
+* OtaServer.h: header file for OtaServer class: firmware update over HTTP, in its own task     *
+*                                                                                              *
+* Version: 0.1                                                                                 *
+* Last updated: 17/10/2026                                                                     *
+* Author: Jim Gunther                                                                          *
+*                                                                                              *
+* The OTA task calls handle(); the network task takes the news and the counts, and restarts    *
+* once restartDue() (see checkReboot()).                                                       *
+***********************************************************************************************/
+
+#define OTA_IDLE 0     // upload states
+#define OTA_RUNNING 1
+#define OTA_DONE 2
+#define OTA_FAILED 3
+
+// One line of news for TOPIC_MESS
+struct otaNote {
+  char txt[BUF_LEN];
+};
+
+class OtaServer {
+  public:
+    OtaServer();
+    void begin();
+    void handle();
+    bool getNews(char* buf, int len);
+    int getCSV(char* buf, int len);
+    bool busy() { return _state.load() == OTA_RUNNING; }
+    bool restartDue() { return _state.load() == OTA_DONE; }
+
+  private:
+    void sendPage();
+    void upload();
+    void finish();
+    void start();
+    void write(uint8_t* buf, size_t len);
+    void end();
+    void fail(const char* why);
+    void note(const char* fmt, ...);
+    WebServer _server;
+    mbedtls_sha256_context _sha;
+    uint8_t _want[32];          // SHA-256 the page worked out for the image
+    std::atomic<int> _state;    // OTA_ states: written by the OTA task, read by the network task
+    uint32_t _bytes;            // written to flash so far
+    uint32_t _chunks;
+    unsigned long _startMs;
+    Ring<otaNote, 4> _news;     // OTA task to network task
+};
+#endif
@@ -0,0 +1,130 @@
+#include "Outbox.h"
+#include <string.h>
+
+/***********************************************************************************************
+* Outbox.cpp: Outbox class: two lanes of queued MQTT messages, data ahead of diagnostics       *
+*                                                                                              *
+* Version: 0.1                                                                                 *
+* Last updated: 17/10/2026                                                                     *
+* Author: Jim Gunther                                                                          *
+*                                                                                              *
+* A record never wraps: if it will not fit between tail and the end of the buffer it goes at   *
+* the start (when there is room before head) and wrapEnd marks where the older records stop.   *
+***********************************************************************************************/
+
+struct outHdr {
+  const char* topic;
+  uint16_t len;
+};
+
+Outbox::Outbox() {
+  _lane[LANE_DATA].buf = _data;
+  _lane[LANE_DATA].size = OUT_DATA_BYTES;
+  _lane[LANE_DIAG].buf = _diag;
+  _lane[LANE_DIAG].size = OUT_DIAG_BYTES;
+  for (int i = 0; i < NUM_LANES; i++) {
+    outLane& l = _lane[i];
+    l.head = l.tail = l.count = 0;
+    l.wrapEnd = -1;
+    l.sent = l.dropped = 0;
+    l.peak = 0;
+  }
+};
+
+/*******************************************************************************************
+put(): copies a message into a lane
+parameters: lane: int, topic: const char*: a string constant, payload: const uint8_t*, len: int
+returns: bool: false (and counted as dropped) if the lane has no room
+********************************************************************************************/
+bool Outbox::put(int lane, const char* topic, const uint8_t* payload, int len) {
+  outLane& l = _lane[lane];
+  int rec = sizeof(outHdr) + len;
+  int at;
+  if (l.wrapEnd < 0) {
+    if (l.tail + rec <= l.size) {
+      at = l.tail;
+    } else if (rec <= l.head) {
+      l.wrapEnd = l.tail;
+      at = 0;
+    } else {
+      l.dropped++;
+      return false;
+    }
+  } else if (l.tail + rec <= l.head) {
+    at = l.tail;
+  } else {
+    l.dropped++;
+    return false;
+  }
+  outHdr h = { topic, (uint16_t)len };
+  memcpy(l.buf + at, &h, sizeof(h));
+  memcpy(l.buf + at + sizeof(h), payload, len);
+  l.tail = at + rec;
+  l.count++;
+  if (used(l) > l.peak) l.peak = used(l);
+  return true;
+}
+
+bool Outbox::put(int lane, const char* topic, const char* txt) {
+  return put(lane, topic, (const uint8_t*)txt, strlen(txt));
+}
+
+/*******************************************************************************************
+drain(): publishes from the head of LANE_DATA, then LANE_DIAG, until maxMsgs have gone, the
+         lanes are empty or a publish fails
+parameters: publish: function that sends one message, returning true if it went out,
+            maxMsgs: int: most to send this call
+returns: int: number sent
+********************************************************************************************/
+int Outbox::drain(bool (*publish)(const char*, const uint8_t*, unsigned int), int maxMsgs) {
+  int n = 0;
+  for (int i = 0; i < NUM_LANES; i++) {
+    outLane& l = _lane[i];
+    while ((n < maxMsgs) && (l.count > 0)) {
+      outHdr h;
+      memcpy(&h, l.buf + l.head, sizeof(h));
+      if (!publish(h.topic, l.buf + l.head + sizeof(h), h.len)) return n;
+      l.head += sizeof(h) + h.len;
+      l.count--;
+      l.sent++;
+      n++;
+      if (l.count == 0) {
+        l.head = l.tail = 0;
+        l.wrapEnd = -1;
+      } else if (l.head == l.wrapEnd) {
+        l.head = 0;
+        l.wrapEnd = -1;
+      }
+    }
+  }
+  return n;
+}
+
+/*******************************************************************************************
+mark(): notes the end of a lane, so messages put after it can be taken back together
+parameters: lane: int
+returns: outMark
+********************************************************************************************/
+outMark Outbox::mark(int lane) {
+  outMark m = { _lane[lane].tail, _lane[lane].wrapEnd, _lane[lane].count };
+  return m;
+}
+
+/*******************************************************************************************
+rollback(): removes everything put since mark() (no drain() in between), e.g. the first parts
+            of a report whose later parts did not fit
+parameters: lane: int, m: const outMark&: from mark()
+returns: void
+********************************************************************************************/
+void Outbox::rollback(int lane, const outMark& m) {
+  outLane& l = _lane[lane];
+  l.tail = m.tail;
+  l.wrapEnd = m.wrapEnd;
+  l.count = m.count;
+  if (l.count == 0) l.head = l.tail = 0;
+}
+
+int Outbox::used(const outLane& l) {
+  if (l.wrapEnd < 0) return l.tail - l.head;
+  return (l.wrapEnd - l.head) + l.tail;
+}
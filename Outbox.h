@@ -0,0 +1,62 @@
+#ifndef OUTBOX_H
+#define OUTBOX_H
+#include <stdint.h>
+#include "Config.h"
+
+/***********************************************************************************************
+* Outbox.h: header file for Outbox class: outbound MQTT messages waiting for the broker, in    *
+*           two priority lanes of preallocated bytes                                           *
+*                                                                                              *
+* Version: 0.1                                                                                 *
+* Last updated: 17/10/2026                                                                     *
+* Author: Jim Gunther                                                                          *
+*                                                                                              *
+* Each lane is a ring of variable-length records: topic pointer, length, payload (the topic    *
+* must be a string constant). drain() empties LANE_DATA before touching LANE_DIAG and stops    *
+* at the first failed publish, leaving that message at the head to go again: nothing is lost   *
+* or reordered while the link is down. put() fails when the lane is full, counting a drop.     *
+* Network task only: no locking.                                                               *
+***********************************************************************************************/
+
+#define LANE_DATA 0  // reports, batches, the interval request and settings echoes
+#define LANE_DIAG 1  // messages and metrics
+#define NUM_LANES 2
+
+struct outLane {
+  uint8_t* buf;
+  int size;
+  int head;     // first byte of the oldest record
+  int tail;     // where the next record goes
+  int wrapEnd;  // end of the records before tail went back to 0 (-1 if it has not)
+  int count;
+  uint32_t sent;
+  uint32_t dropped;
+  int peak;     // most bytes ever waiting
+};
+
+struct outMark {
+  int tail;
+  int wrapEnd;
+  int count;
+};
+
+class Outbox {
+  public:
+    Outbox();
+    bool put(int lane, const char* topic, const uint8_t* payload, int len);
+    bool put(int lane, const char* topic, const char* txt);
+    int drain(bool (*publish)(const char*, const uint8_t*, unsigned int), int maxMsgs);
+    outMark mark(int lane);
+    void rollback(int lane, const outMark& m);
+    int count(int lane) { return _lane[lane].count; }
+    uint32_t sent(int lane) { return _lane[lane].sent; }
+    uint32_t dropped(int lane) { return _lane[lane].dropped; }
+    int peak(int lane) { return _lane[lane].peak; }
+
+  private:
+    int used(const outLane& l);
+    uint8_t _data[OUT_DATA_BYTES];
+    uint8_t _diag[OUT_DIAG_BYTES];
+    outLane _lane[NUM_LANES];
+};
+#endif
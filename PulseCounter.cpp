@@ -0,0 +1,179 @@
+#include "PulseCounter.h"
+#include "Ring.h"
+#include "Arduino.h"
+
+/***********************************************************************************************
+* PulseCounter.cpp: PulseCounter class: the anemometer and rain gauge counting backends        *
+*                                                                                              *
+* Version: 0.1                                                                                 *
+* Last updated: 17/10/2026                                                                     *
+* Author: Jim Gunther                                                                          *
+*                                                                                              *
+* COUNT_ISR:  an interrupt per edge, debounced in software; each revolution's time goes to     *
+*             the gust meter, so gusts are exact                                               *
+* COUNT_PCNT: the PCNT peripheral counts edges through its hardware glitch filter and the      *
+*             counts are read at each poll: no interrupts at all. The gust meter is given each *
+*             poll's revs spread evenly over the poll, so gusts are good to about LOOP_TIME.   *
+* Rain: one edge per tip (the reed closing), and nothing within RAIN_MARGIN_MS of the last     *
+* tip, so a tip is counted once however its edges bounce or fall across polls. Each tip's      *
+* time goes to the rain meter: exact with COUNT_ISR, to the poll with COUNT_PCNT.              *
+***********************************************************************************************/
+
+#if COUNT_BACKEND == COUNT_ISR
+
+// Interrupt Service Routines start here______________
+
+// Rain
+
+volatile uint32_t _lastRTime  = 0;
+volatile int _tipsCount; // number of rain bucket tips (since reset())
+Ring<uint32_t, TIP_RING_LEN> _tipTimes;
+
+void IRAM_ATTR buckets_tipped();
+void buckets_tipped() {
+  uint32_t thisRTime = (uint32_t)(esp_timer_get_time() / 1000);  // msecs: the same clock as millis()
+  if (thisRTime - _lastRTime > RAIN_MARGIN_MS) {
+    _tipsCount++;
+    _lastRTime = thisRTime;
+    _tipTimes.push(thisRTime);
+  }
+}
+
+// Wind: each revolution's time goes in a lock-free ring for poll() to read
+volatile int _currRevs = 0;
+volatile uint32_t _lastSTime = 0;
+Ring<uint32_t, PULSE_RING_LEN> _pulses;
+
+void IRAM_ATTR one_Rotation();
+void one_Rotation() {
+  uint32_t thisSTime = (uint32_t)esp_timer_get_time();  // usecs: no divide in the ISR
+  if (thisSTime - _lastSTime > MARGIN_US) {
+    _currRevs++;
+    _lastSTime = thisSTime;
+    _pulses.push(thisSTime);
+  }
+}
+// ------------------------ END OF ISRs --------------------------------------------------------------
+
+PulseCounter::PulseCounter() {};
+
+bool PulseCounter::begin() {
+  _tipsCount = 0;
+  _currRevs = 0;
+  _lastRTime = (uint32_t)(esp_timer_get_time() / 1000);  // not a tip at power-up
+  attachInterrupt(digitalPinToInterrupt(RainPin), buckets_tipped, FALLING); // rain buckets
+  attachInterrupt(digitalPinToInterrupt(RevsPin), one_Rotation, RISING);  // anemometer
+  return true;
+}
+
+void PulseCounter::poll(uint32_t nowUs, GustMeter& gusts, RainMeter& rain) {
+  uint32_t t;
+  while (_pulses.pop(t)) gusts.addPulse(t);
+  while (_tipTimes.pop(t)) rain.addTip(t);
+}
+
+int PulseCounter::revs() {
+  return _currRevs;
+}
+
+int PulseCounter::tips() {
+  return _tipsCount;
+}
+
+void PulseCounter::reset() {
+  _currRevs = 0;
+  _tipsCount = 0;
+}
+
+#else  // COUNT_PCNT
+
+PulseCounter::PulseCounter() {
+  _revsUnit = _tipsUnit = NULL;
+  _revsLast = _tipsLast = 0;
+  _revs = _tips = 0;
+  _lastTip = 0;
+};
+
+/**************************************************************************************************
+begin(): sets up a PCNT unit for each input
+parameters: none
+returns: bool: false if the driver refused (nothing will be counted)
+***************************************************************************************************/
+bool PulseCounter::begin() {
+  _lastTip = (uint32_t)(esp_timer_get_time() / 1000);
+  return startUnit(_revsUnit, RevsPin, false) && startUnit(_tipsUnit, RainPin, true);
+}
+
+/**************************************************************************************************
+startUnit(): one PCNT unit counting up on one pin's edges, through the glitch filter. The unit
+             clears itself at PCNT_HIGH, which delta() allows for.
+parameters: unit: pcnt_unit_handle_t&: receives the unit, pin: int, falling: bool: count falling edges, not rising
+returns: bool: true if running
+***************************************************************************************************/
+bool PulseCounter::startUnit(pcnt_unit_handle_t& unit, int pin, bool falling) {
+  pcnt_unit_config_t unitConfig = {};
+  unitConfig.low_limit = -1;
+  unitConfig.high_limit = PCNT_HIGH;
+  pcnt_glitch_filter_config_t filterConfig = {};
+  filterConfig.max_glitch_ns = PCNT_GLITCH_NS;
+  pcnt_chan_config_t chanConfig = {};
+  chanConfig.edge_gpio_num = pin;
+  chanConfig.level_gpio_num = -1;
+  pcnt_channel_handle_t chan;
+
+  pinMode(pin, INPUT_PULLUP);
+  if (pcnt_new_unit(&unitConfig, &unit) != ESP_OK) return false;
+  if ((pcnt_unit_set_glitch_filter(unit, &filterConfig) != ESP_OK) || (pcnt_new_channel(unit, &chanConfig, &chan) != ESP_OK) ||
+      (pcnt_channel_set_edge_action(chan, falling ? PCNT_CHANNEL_EDGE_ACTION_HOLD : PCNT_CHANNEL_EDGE_ACTION_INCREASE,
+                                    falling ? PCNT_CHANNEL_EDGE_ACTION_INCREASE : PCNT_CHANNEL_EDGE_ACTION_HOLD) != ESP_OK)) {
+    return false;
+  }
+  return (pcnt_unit_enable(unit) == ESP_OK) && (pcnt_unit_clear_count(unit) == ESP_OK) && (pcnt_unit_start(unit) == ESP_OK);
+}
+
+/**************************************************************************************************
+delta(): counts since the last call
+parameters: unit: pcnt_unit_handle_t, last: int&: the count last time (updated)
+returns: int: new counts
+***************************************************************************************************/
+int PulseCounter::delta(pcnt_unit_handle_t unit, int& last) {
+  int now;
+  if ((unit == NULL) || (pcnt_unit_get_count(unit, &now) != ESP_OK)) return 0;
+  int d = now - last;
+  if (d < 0) d += PCNT_HIGH;  // the unit went through PCNT_HIGH and cleared
+  last = now;
+  return d;
+}
+
+/**************************************************************************************************
+poll(): reads both counters; the new revs go to the gust meter spread over the time since last poll,
+        and a tip (however many edges) to the rain meter at the poll's time
+parameters: nowUs: uint32_t: esp_timer_get_time(), gusts: GustMeter&, rain: RainMeter&
+returns: void
+***************************************************************************************************/
+void PulseCounter::poll(uint32_t nowUs, GustMeter& gusts, RainMeter& rain) {
+  int n = delta(_revsUnit, _revsLast);
+  _revs += n;
+  gusts.addCount(nowUs, n);
+  uint32_t nowMs = (uint32_t)(esp_timer_get_time() / 1000);  // nowUs wraps too soon for rain
+  if ((delta(_tipsUnit, _tipsLast) > 0) && (nowMs - _lastTip > RAIN_MARGIN_MS)) {
+    _tips++;
+    _lastTip = nowMs;
+    rain.addTip(nowMs);
+  }
+}
+
+int PulseCounter::revs() {
+  return _revs;
+}
+
+int PulseCounter::tips() {
+  return _tips;
+}
+
+void PulseCounter::reset() {
+  _revs = 0;
+  _tips = 0;
+}
+
+#endif
@@ -0,0 +1,42 @@
+#ifndef PULSE_COUNTER_H
+#define PULSE_COUNTER_H
+#include <stdint.h>
+#include "Config.h"
+#include "GustMeter.h"
+#include "RainMeter.h"
+#if COUNT_BACKEND == COUNT_PCNT
+#include <driver/pulse_cnt.h>
+#endif
+
+/***********************************************************************************************
+* PulseCounter.h: header file for PulseCounter class: anemometer revs and rain bucket tips,    *
+*                 counted by interrupts (COUNT_ISR) or by the PCNT peripheral (COUNT_PCNT)     *
+*                                                                                              *
+* Version: 0.1                                                                                 *
+* Last updated: 17/10/2026                                                                     *
+* Author: Jim Gunther                                                                          *
+*                                                                                              *
+***********************************************************************************************/
+class PulseCounter {
+  public:
+    PulseCounter();
+    bool begin();
+    void poll(uint32_t nowUs, GustMeter& gusts, RainMeter& rain);
+    int revs();
+    int tips();
+    void reset();
+
+#if COUNT_BACKEND == COUNT_PCNT
+  private:
+    bool startUnit(pcnt_unit_handle_t& unit, int pin, bool falling);
+    int delta(pcnt_unit_handle_t unit, int& last);
+    pcnt_unit_handle_t _revsUnit;
+    pcnt_unit_handle_t _tipsUnit;
+    int _revsLast;  // hardware counts at the last poll
+    int _tipsLast;
+    int _revs;      // counted since reset()
+    int _tips;
+    uint32_t _lastTip;  // millis of the last tip counted
+#endif
+};
+#endif
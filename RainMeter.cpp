@@ -0,0 +1,82 @@
+#include "RainMeter.h"
+
+/***********************************************************************************************
+* RainMeter.cpp: RainMeter class: rain rate (mm/h) over a sliding window, worked out from the  *
+*                times between rain gauge bucket tips                                          *
+*                                                                                              *
+* Version: 0.1                                                                                 *
+* Last updated: 17/10/2026                                                                     *
+* Author: Jim Gunther                                                                          *
+*                                                                                              *
+* The RAIN_MM_PER_TIP that made each tip fell evenly over the time since the tip before, so a  *
+* window gets the share of each inter-tip interval that lies inside it. Light rain (a tip      *
+* every few minutes) then gives a steady rate instead of 0 or one whole tip. Since the last    *
+* tip the rain is taken as no heavier than the last interval and no heavier than one tip over  *
+* the time so far, so the rate falls away as the rain stops, and is 0 after RAIN_STOP_MS.      *
+***********************************************************************************************/
+
+RainMeter::RainMeter() {
+  _count = 0;
+  _first = 0;
+  reset();
+};
+
+/**************************************************************************************************
+addTip(): takes one bucket tip
+parameters: tMs: uint32_t: tip time (millis; only differences are used)
+returns: void
+***************************************************************************************************/
+void RainMeter::addTip(uint32_t tMs) {
+  if (_count == RAIN_HIST) {  // lose the oldest
+    _first = (_first + 1) % RAIN_HIST;
+    _count--;
+  }
+  _hist[(_first + _count) % RAIN_HIST] = tMs;
+  _count++;
+}
+
+/**************************************************************************************************
+update(): reviews the interval's peak rate (call often: every loop)
+parameters: nowMs: uint32_t: millis()
+returns: void
+***************************************************************************************************/
+void RainMeter::update(uint32_t nowMs) {
+  if ((_count == 0) || (nowMs - tipAt(_count - 1) >= RAIN_STOP_MS + RAIN_PEAK_WINDOW)) return;  // dry
+  float r = rate(nowMs, RAIN_PEAK_WINDOW);
+  if (r > _peak) _peak = r;
+}
+
+/**************************************************************************************************
+rate(): the mean rain rate over the last windowMs (no longer than RAIN_STOP_MS)
+parameters: nowMs: uint32_t: millis(), windowMs: uint32_t: window length
+returns: float: mm/h
+***************************************************************************************************/
+float RainMeter::rate(uint32_t nowMs, uint32_t windowMs) {
+  if (_count == 0) return 0.0f;
+  float tips = 0.0f;  // tips' worth of rain inside the window
+  uint32_t last = tipAt(_count - 1);
+  uint32_t since = nowMs - last;
+  if (since < RAIN_STOP_MS) {  // still raining: the interval so far
+    uint32_t gap = (_count > 1) ? last - tipAt(_count - 2) : RAIN_STOP_MS;
+    if (since > gap) gap = since;
+    if (gap > 0) tips += (float)((since < windowMs) ? since : windowMs) / (float)gap;
+  }
+  for (int i = _count - 1; i >= 0; i--) {  // intervals that ended inside the window, newest first
+    uint32_t end = nowMs - tipAt(i);     // how long ago it ended ...
+    if (end >= windowMs) break;
+    uint32_t begin = (i > 0) ? nowMs - tipAt(i - 1) : end + RAIN_STOP_MS;  // ... and began (first: dry before)
+    if (begin - end == 0) continue;
+    uint32_t inside = ((begin < windowMs) ? begin : windowMs) - end;
+    tips += (float)inside / (float)(begin - end);
+  }
+  return tips * RAIN_MM_PER_TIP * 3600000.0f / (float)windowMs;
+}
+
+/**************************************************************************************************
+reset(): starts a new report interval (the tip history carries on across the boundary)
+parameters: none
+returns: void
+***************************************************************************************************/
+void RainMeter::reset() {
+  _peak = 0.0f;
+}
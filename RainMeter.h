@@ -0,0 +1,30 @@
+#ifndef RAIN_METER_H
+#define RAIN_METER_H
+#include <stdint.h>
+#include "Config.h"
+
+/***********************************************************************************************
+* RainMeter.h: header file for RainMeter class: rain rate from rain gauge bucket tip times     *
+*                                                                                              *
+* Version: 0.1                                                                                 *
+* Last updated: 17/10/2026                                                                     *
+* Author: Jim Gunther                                                                          *
+*                                                                                              *
+***********************************************************************************************/
+class RainMeter {
+  public:
+    RainMeter();
+    void addTip(uint32_t tMs);
+    void update(uint32_t nowMs);
+    float rate(uint32_t nowMs, uint32_t windowMs);
+    void reset();
+    float getPeak() { return _peak; }  // highest RAIN_PEAK_WINDOW rate this interval (mm/h)
+
+  private:
+    uint32_t tipAt(int i) { return _hist[(_first + i) % RAIN_HIST]; }
+    uint32_t _hist[RAIN_HIST];  // recent tip times (millis), oldest at _first
+    int _count;
+    int _first;
+    float _peak;
+};
+#endif
@@ -0,0 +1,121 @@
+#include "RateControl.h"
+#include <math.h>
+
+/***********************************************************************************************
+* RateControl.cpp: RateControl class: activity profile with hysteresis, and what each profile  *
+*                  means for the report interval and the meteo sampling periods                *
+*                                                                                              *
+* Version: 0.1                                                                                 *
+* Last updated: 17/10/2026                                                                     *
+* Author: Jim Gunther                                                                          *
+*                                                                                              *
+* Storm: mean revs/sec, their standard deviation second to second (gustiness) or tips in the   *
+* window at or above the _ON thresholds. Calm: no tips and hardly any revs.                    *
+***********************************************************************************************/
+
+static const int intvlPct[NUM_PROFILES] = PROF_INTVL_PCT;
+static const int periodX[NUM_PROFILES] = PROF_PERIOD_X;
+
+RateControl::RateControl() {
+  for (int i = 0; i < PROF_WINDOW; i++) {
+    _revs[i] = 0;
+    _tips[i] = 0;
+  }
+  _pos = _n = 0;
+  _sum = _sumSq = 0;
+  _tipSum = 0;
+  _profile = PROF_NORMAL;
+  _held = 0;
+  _pinned = PROF_AUTO;
+};
+
+/*******************************************************************************************
+addSecond(): adds one second's counts to the window and reviews the profile
+parameters: revs: int: anemometer revs this second, tips: int: rain gauge tips this second
+returns: bool: true if the profile changed
+********************************************************************************************/
+bool RateControl::addSecond(int revs, int tips) {
+  revs = (revs < 0) ? 0 : ((revs > 1000) ? 1000 : revs);  // keeps _sumSq well inside 32 bits
+  tips = (tips < 0) ? 0 : ((tips > 0xFF) ? 0xFF : tips);
+  _sum += revs - _revs[_pos];
+  _sumSq += revs * revs - _revs[_pos] * _revs[_pos];
+  _tipSum += tips - _tips[_pos];
+  _revs[_pos] = revs;
+  _tips[_pos] = tips;
+  _pos = (_pos + 1) % PROF_WINDOW;
+  if (_n < PROF_WINDOW) _n++;
+  if (_pinned != PROF_AUTO) return false;
+
+  float mean = meanRevs();
+  float sd = sdRevs();
+  bool stormOn = (mean >= STORM_REVS_ON) || (sd >= STORM_SD_ON) || (_tipSum >= STORM_TIPS_ON);
+  bool stormOff = (mean < STORM_REVS_OFF) && (sd < STORM_SD_OFF) && (_tipSum < STORM_TIPS_OFF);
+  bool calmOn = (_n == PROF_WINDOW) && (mean <= CALM_REVS_ON) && (_tipSum == 0);
+  bool calmOff = (mean > CALM_REVS_OFF) || (_tipSum > 0);
+  int next = _profile;
+
+  switch (_profile) {
+    case PROF_STORM:
+      _held = stormOff ? _held + 1 : 0;
+      if (_held >= PROF_HOLD) next = PROF_NORMAL;
+      break;
+    case PROF_NORMAL:
+      _held = calmOn ? _held + 1 : 0;
+      if (stormOn) next = PROF_STORM;
+      else if (_held >= PROF_HOLD) next = PROF_CALM;
+      break;
+    case PROF_CALM:
+      if (stormOn) next = PROF_STORM;
+      else if (calmOff) next = PROF_NORMAL;
+      break;
+  }
+  if (next == _profile) return false;
+  _profile = next;
+  _held = 0;
+  return true;
+}
+
+/*******************************************************************************************
+pin(): holds a profile from now on, or lets the weather pick again
+parameters: profile: int: PROF_CALM, PROF_NORMAL, PROF_STORM or PROF_AUTO
+returns: bool: true if the profile changed
+********************************************************************************************/
+bool RateControl::pin(int profile) {
+  if ((profile < PROF_AUTO) || (profile >= NUM_PROFILES)) return false;
+  _pinned = profile;
+  _held = 0;
+  if ((profile == PROF_AUTO) || (profile == _profile)) return false;
+  _profile = profile;
+  return true;
+}
+
+/*******************************************************************************************
+intervalLoops(): the report interval for the current profile (PROF_INTVL_PCT of the Shed's),
+                 kept to whole seconds
+parameters: baseLoops: int: the Shed's report interval (loops)
+returns: int: loops
+********************************************************************************************/
+int RateControl::intervalLoops(int baseLoops) {
+  int loops = (int)((long)baseLoops * intvlPct[_profile] / 100) / ZONE4 * ZONE4;
+  return (loops < ZONE4) ? ZONE4 : loops;
+}
+
+/*******************************************************************************************
+periodScale(): what the meteo sampling periods (METEO_ITEMS, SENSOR_PERIOD) are multiplied by
+parameters: none
+returns: int
+********************************************************************************************/
+int RateControl::periodScale() {
+  return periodX[_profile];
+}
+
+float RateControl::meanRevs() {
+  return (_n > 0) ? (float)_sum / _n : 0.0f;
+}
+
+float RateControl::sdRevs() {
+  if (_n == 0) return 0.0f;
+  float mean = (float)_sum / _n;
+  float var = (float)_sumSq / _n - mean * mean;
+  return (var > 0.0f) ? sqrtf(var) : 0.0f;
+}
@@ -0,0 +1,52 @@
+#ifndef RATE_CONTROL_H
+#define RATE_CONTROL_H
+#include <stdint.h>
+#include "Config.h"
+
+/***********************************************************************************************
+* RateControl.h: header file for RateControl class: picks the calm, normal or storm profile    *
+*                from the last PROF_WINDOW seconds of wind and rain                            *
+*                                                                                              *
+* Version: 0.1                                                                                 *
+* Last updated: 17/10/2026                                                                     *
+* Author: Jim Gunther                                                                          *
+*                                                                                              *
+* Fed once a second with that second's revs and tips. Moving up (calm to normal, anything to   *
+* storm) is immediate; moving down needs the lower thresholds (_OFF for storm, _ON for calm)   *
+* to have held for PROF_HOLD seconds, so a lull does not flip the profile back and forth.      *
+* pin() holds one profile whatever the weather (TOPIC_CONFIG); the window keeps filling.       *
+***********************************************************************************************/
+
+#define PROF_CALM 0
+#define PROF_NORMAL 1
+#define PROF_STORM 2
+#define NUM_PROFILES 3
+#define PROF_TAGS "CNS"  // the profile's letter in published records
+#define PROF_AUTO -1     // not pinned: see pin()
+
+class RateControl {
+  public:
+    RateControl();
+    bool addSecond(int revs, int tips);
+    bool pin(int profile);
+    int pinned() { return _pinned; }
+    int profile() { return _profile; }
+    char tag() { return PROF_TAGS[_profile]; }
+    int intervalLoops(int baseLoops);
+    int periodScale();
+    float meanRevs();
+    float sdRevs();
+
+  private:
+    uint16_t _revs[PROF_WINDOW];  // revs in each of the last PROF_WINDOW seconds
+    uint8_t _tips[PROF_WINDOW];
+    int _pos;
+    int _n;
+    int32_t _sum;
+    int32_t _sumSq;
+    int _tipSum;
+    int _profile;
+    int _held;  // seconds the conditions for moving down have held
+    int _pinned;  // PROF_AUTO, or the profile held by pin()
+};
+#endif
@@ -0,0 +1,115 @@
+#include "RecordLog.h"
+#include "Arduino.h"
+#include <LittleFS.h>
+
+/***********************************************************************************************
+* RecordLog.cpp: RecordLog class: ring of fixed-size report records in a LittleFS file.       *
+*                Written only when a post fails; read back oldest first once MQTT returns.    *
+*                                                                                              *
+* Version: 0.1                                                                                 *
+* Last updated: 17/10/2026                                                                     *
+* Author: Jim Gunther                                                                          *
+*                                                                                              *
+***********************************************************************************************/
+
+#define LOG_MAGIC 0x52463406UL  // "RF4" + layout version: a mismatch starts a fresh log
+
+RecordLog::RecordLog() {};
+
+/*****************************************************************************************************
+begin(): mounts LittleFS (formatting it the first time) and opens or creates the log file
+parameters: none
+returns: bool: true if the log can be used
+*****************************************************************************************************/
+bool RecordLog::begin() {
+  _ok = false;
+  memset(&_hdr, 0, sizeof(_hdr));
+  if (!LittleFS.begin(true)) return false;
+  File f = LittleFS.open(LOG_FILE, "r");
+  if (f) {
+    bool good = (f.read((uint8_t*)&_hdr, sizeof(_hdr)) == sizeof(_hdr)) && (_hdr.magic == LOG_MAGIC) &&
+                (_hdr.head - _hdr.tail <= LOG_SLOTS);
+    f.close();
+    if (good) {
+      _ok = true;
+      return true;
+    }
+  }
+  memset(&_hdr, 0, sizeof(_hdr));
+  _hdr.magic = LOG_MAGIC;
+  f = LittleFS.open(LOG_FILE, "w");
+  if (!f) return false;
+  f.write((const uint8_t*)&_hdr, sizeof(_hdr));
+  f.close();
+  _ok = true;
+  return true;
+}
+
+/*****************************************************************************************************
+append(): adds a report at the head; when full the oldest record is overwritten (and counted lost)
+parameters: rep: const report&
+returns: bool: true if stored
+*****************************************************************************************************/
+bool RecordLog::append(const report& rep) {
+  if (!_ok) return false;
+  File f = LittleFS.open(LOG_FILE, "r+");
+  if (!f) return false;
+  bool done = f.seek(sizeof(logHeader) + (_hdr.head % LOG_SLOTS) * sizeof(report)) &&
+              (f.write((const uint8_t*)&rep, sizeof(report)) == sizeof(report));
+  f.close();
+  if (!done) return false;
+  _hdr.head++;
+  if (_hdr.head - _hdr.tail > LOG_SLOTS) {
+    _hdr.tail++;
+    _hdr.lost++;
+  }
+  if (rep.seq + 1 > _hdr.nextSeq) _hdr.nextSeq = rep.seq + 1;
+  return writeHeader();
+}
+
+/*****************************************************************************************************
+peek(): reads a record without removing it
+parameters: rep: report&: receives it, ahead: uint32_t: how many after the oldest (0: the oldest)
+returns: bool: false if there is no such record or it is unreadable
+*****************************************************************************************************/
+bool RecordLog::peek(report& rep, uint32_t ahead) {
+  if (!_ok || (ahead >= count())) return false;
+  File f = LittleFS.open(LOG_FILE, "r");
+  if (!f) return false;
+  bool done = f.seek(sizeof(logHeader) + ((_hdr.tail + ahead) % LOG_SLOTS) * sizeof(report)) &&
+              (f.read((uint8_t*)&rep, sizeof(report)) == sizeof(report));
+  f.close();
+  return done;
+}
+
+/*****************************************************************************************************
+drop(): removes the oldest record (after it has been posted)
+parameters: none
+returns: void
+*****************************************************************************************************/
+void RecordLog::drop() {
+  if (!_ok || (count() == 0)) return;
+  _hdr.tail++;
+  writeHeader();
+}
+
+/*****************************************************************************************************
+saveSeq(): remembers where sequence numbering should carry on after a restart. Called with a
+           block of numbers in hand (SEQ_BLOCK) so the flash is written once per block, not per
+           interval; a restart skips the rest of the block but never reuses a number.
+parameters: nextSeq: uint32_t
+returns: void
+*****************************************************************************************************/
+void RecordLog::saveSeq(uint32_t nextSeq) {
+  if (!_ok || (nextSeq == _hdr.nextSeq)) return;
+  _hdr.nextSeq = nextSeq;
+  writeHeader();
+}
+
+bool RecordLog::writeHeader() {
+  File f = LittleFS.open(LOG_FILE, "r+");
+  if (!f) return false;
+  bool done = f.write((const uint8_t*)&_hdr, sizeof(_hdr)) == sizeof(_hdr);
+  f.close();
+  return done;
+}
@@ -0,0 +1,43 @@
+#ifndef RECORD_LOG_H
+#define RECORD_LOG_H
+#include "Config.h"
+#include "WInputs.h"
+
+/***********************************************************************************************
+* RecordLog.h: header file for RecordLog class: reports that could not be posted, kept in     *
+*              flash until the broker is back                                                  *
+*                                                                                              *
+* Version: 0.1                                                                                 *
+* Last updated: 17/10/2026                                                                     *
+* Author: Jim Gunther                                                                          *
+*                                                                                              *
+***********************************************************************************************/
+
+// File header: head and tail only ever count up; slot = count % LOG_SLOTS
+struct logHeader {
+  uint32_t magic;
+  uint32_t head;     // next record to write
+  uint32_t tail;     // oldest record not yet posted
+  uint32_t nextSeq;  // report sequence number to carry on from after a restart
+  uint32_t lost;     // records overwritten because the log was full
+};
+
+class RecordLog {
+  public:
+    RecordLog();
+    bool begin();
+    bool append(const report& rep);
+    bool peek(report& rep, uint32_t ahead = 0);
+    void drop();
+    void saveSeq(uint32_t nextSeq);
+    uint32_t count() { return _hdr.head - _hdr.tail; }
+    uint32_t tail() { return _hdr.tail; }  // position of the oldest record (only ever counts up)
+    uint32_t nextSeq() { return _hdr.nextSeq; }
+    uint32_t lost() { return _hdr.lost; }
+
+  private:
+    bool writeHeader();
+    bool _ok;
+    logHeader _hdr;
+};
+#endif
@@ -0,0 +1,51 @@
+#ifndef RING_H
+#define RING_H
+#include <stdint.h>
+#include <atomic>
+
+/***********************************************************************************************
+* Ring.h: lock-free single-producer/single-consumer ring buffer (template, header only)       *
+*                                                                                              *
+* Version: 0.1                                                                                 *
+* Last updated: 17/10/2026                                                                     *
+* Author: Jim Gunther                                                                          *
+*                                                                                              *
+* One task (or ISR) may push and one other task may pop, with no locks and no allocation.     *
+* N must be a power of 2. When full, push() fails and the dropped count goes up.               *
+***********************************************************************************************/
+template <typename T, uint32_t N>
+class Ring {
+  static_assert((N & (N - 1)) == 0, "Ring size must be a power of 2");
+
+  public:
+    Ring() : _head(0), _tail(0), _dropped(0) {}
+
+    bool push(const T& item) {
+      uint32_t h = _head.load(std::memory_order_relaxed);
+      if (h - _tail.load(std::memory_order_acquire) >= N) {
+        _dropped++;
+        return false;
+      }
+      _buf[h & (N - 1)] = item;
+      _head.store(h + 1, std::memory_order_release);
+      return true;
+    }
+
+    bool pop(T& item) {
+      uint32_t t = _tail.load(std::memory_order_relaxed);
+      if (t == _head.load(std::memory_order_acquire)) return false;
+      item = _buf[t & (N - 1)];
+      _tail.store(t + 1, std::memory_order_release);
+      return true;
+    }
+
+    uint32_t count() const { return _head.load(std::memory_order_acquire) - _tail.load(std::memory_order_acquire); }
+    uint32_t dropped() const { return _dropped; }
+
+  private:
+    T _buf[N];
+    std::atomic<uint32_t> _head;
+    std::atomic<uint32_t> _tail;
+    uint32_t _dropped;  // written by the producer only
+};
+#endif
@@ -10,11 +10,12 @@
 #include <WiFi.h>
 #include <NTPClient.h>
 #include <WiFiUdp.h>
-#include <WiFiClient.h>  //OTA
-#include <WebServer.h>   //OTA
+#include <WiFiClient.h>
 #include <ESPmDNS.h>     //OTA
-#include <Update.h>      //OTA
 #include <PubSubClient.h>
+#if LIGHT_SLEEP && defined(CONFIG_PM_ENABLE)
+#include <esp_pm.h>
+#endif
 
 /*
 library WiFi at version 3.1.3 
@@ -38,11 +39,24 @@ library BH1750 at version 1.3.0
 #include "Config.h"
 #include "Komms.h"
 #include "WInputs.h"
+#include "Ring.h"
+#include "Telemetry.h"
+#include "RecordLog.h"
+#include "Batcher.h"
+#include "ZoneMetrics.h"
+#include "MqttLink.h"
+#include "Outbox.h"
+#include "MemWatch.h"
+#include "OtaServer.h"
 
 // Class instantiation
-WebServer server(80);  // OTA
 Komms kom;
 WInputs wi;
+RecordLog rlog;
+Batcher batch;
+Outbox out;  // network task only: everything published waits here for drain()
+MemWatch mem;  // network task only
+OtaServer ota;  // OTA task; news, counts and restart read by the network task
 
 const char* host = "esp32";  // OTA
 
@@ -50,37 +64,85 @@ const char* host = "esp32";  // OTA
 // MQTT stuff
 WiFiClient espClient;
 PubSubClient qtClient(espClient);
+MqttLink link(qtClient);
+int linkDrops = 0;
 int nwkIx;
 bool bNewMQTT = false;
+uint32_t replayFrom = 0;  // network task: log position of the reports replayLog() has queued ...
+int replayed = 0;         // ... how many (still in the log until the data lane empties) ...
+uint32_t replaySeq = 0;   // ... and the last one's sequence number
 unsigned int icLength;
 byte bqticBuf[QT_LEN];
 char qticBuf[QT_LEN];
 char qtogBuf[QT_LEN];
 char mqttServer[IP_LEN];
 char versionBuf[52];
+char cfgBuf[CFG_LEN];       // the last TOPIC_CONFIG payload ...
+unsigned int cfgLen;        // ... its length as sent
+bool bNewConfig = false;
+runConfig cfgNext;          // network task: settings as the last change taken will leave them
+runConfig cfgEcho;          // network task: the last settings applied ...
+bool bEchoDue = false;      // ... until their echo is in the outbox
 
 // Array and variables initiation
 unsigned long loopStart;
+unsigned long lastMetrics = 0;
 int loopCount = 0;
-int rptIntvl = 120;  // default value
+volatile int rptIntvl = 120;      // default value
+int nextRptIntvl = 120;           // sampling task: the Shed's interval, set only by applyConfig()
+int blinkLoops = ZONE12;          // sampling task: ZONE 12's period (TOPIC_CONFIG can change it)
 int maxGust;
-unsigned long rebootTime;
+bool rebootWanted = false;  // MemWatch found headroom running low, or a new image is in ...
+bool rebootNow = false;     // ... and an interval has since been posted or logged
+unsigned long rebootAt;
+bool ntpDone = false;     // NTP and the Shed's report interval arrive after sampling has started
+unsigned long lastNtpTry = 0;
+bool rptWanted = true;   // until the Shed has answered (or not) a requestRptInterval()
+bool rptPending = false;
+unsigned long rptAskedAt;
+
+// Tasks and the queues between them: sampling task -> network task, but for settings changes
+struct message {
+  char txt[BUF_LEN];
+};
+TaskHandle_t sampleHandle;
+TaskHandle_t netHandle;
+TaskHandle_t otaHandle;
+Ring<report, REPORT_Q_LEN> reportQ;
+Ring<message, MSG_Q_LEN> msgQ;
+Ring<runConfig, CFG_Q_LEN> cfgQ;      // network task -> sampling task: applied at the next interval boundary
+Ring<runConfig, CFG_Q_LEN> appliedQ;  // and back once they have been, to be echoed
+uint8_t batchBuf[(BATCH_COUNT > 1) ? BATCH_BYTES : 1];  // network task only (and only used when batching)
 
 /******************************************************************************************************/
 
+/*********************************************************************************************************************
+qtCallback(): takes an incoming MQTT message (network task, inside qtClient.loop()): settings for checkConfig(),
+              anything else for checkStartup(). Copies are cut to fit and always terminated.
+parameters: topic: char*, message: byte*: payload, length: unsigned int: payload length
+returns: void
+**********************************************************************************************************************/
 void qtCallback(char* topic, byte* message, unsigned int length) {
-  for (int i = 0; i < length; i++) {
-    qticBuf[i] = (char)message[i];
+  if (strcmp(topic, TOPIC_CONFIG) == 0) {
+    unsigned int n = (length < CFG_LEN - 1) ? length : CFG_LEN - 1;
+    memcpy(cfgBuf, message, n);
+    cfgBuf[n] = '\0';
+    cfgLen = length;
+    bNewConfig = true;
+    return;
   }
+  unsigned int n = (length < QT_LEN - 1) ? length : QT_LEN - 1;
+  memcpy(qticBuf, message, n);
+  qticBuf[n] = '\0';
   bNewMQTT = true;
 }
 
 /*********************************************************************************************************************
-qtSetup(): sets up MQTT connection
+qtSetup(): sets up the MQTT client and hands the connection to the link (see MqttLink.h)
 parameters: nwkIx: int: index no. of wifi network (0-2) Shed, Jim, Richard
-returns: boolean True for success, False for failure
+returns: void
 **********************************************************************************************************************/
-bool qtSetup(int nwkIx) {
+void qtSetup(int nwkIx) {
   switch (nwkIx) {
     case 0:
       strcpy(mqttServer, SHED_IP);
@@ -93,63 +155,68 @@ bool qtSetup(int nwkIx) {
       break;
   }
 
+  espClient.setConnectionTimeout(MQTT_CONNECT_MS);
   qtClient.setServer(mqttServer, 1883);
   qtClient.setCallback(qtCallback);
-  return qtReconnect();
+  qtClient.setBufferSize(MQTT_BUF_LEN);  // batches and metrics are longer than the library's 256
+  link.begin("misRoof", linkUp, linkDown);
 }
 
 /*********************************************************************************************************************
-qtReconnect(): does the actual connection to MQTT broker (3 attempts)
+linkUp(): called by the link on connecting: red LED off, says how long it was down, subscribes to the settings
+          (the retained ones come straight back) and asks the Shed for the report interval if that is still
+          wanted (subscriptions do not survive a reconnect)
 parameters: none
-returns: boolean: True for success, False for failure
+returns: void
 **********************************************************************************************************************/
-bool qtReconnect() {
-
-  // Loop until we're reconnected
-  int numTries = 0;
-
-  while (!qtClient.connected() && (numTries++ < 3)) {
-    fn_RedLed(ON);
-    Serial.print("Attempting MQTT connection...");
-    // Attempt to connect
-    if (qtClient.connect("misRoof")) {
-      Serial.println("connected");
-      qtClient.loop();
-      fn_RedLed(OFF);
-    } else {
-      Serial.print("failed, rc=");
-      Serial.print(qtClient.state());
-      Serial.println(" try again in 3 seconds");
-      // Wait 3 seconds before retrying
-      delay(3000);
-    }
+void linkUp() {
+  char buf[BUF_LEN];
+  fn_RedLed(OFF);
+  Serial.println("MQTT connected");
+  if ((linkDrops > 0) || (link.getTries() > 1)) {
+    snprintf(buf, BUF_LEN - 2, "MQTT up after %lu ms down, %u tries; %d drops", link.getDownMs(),
+             (unsigned)link.getTries(), linkDrops);
+    postMessage(buf);
   }
+  qtClient.subscribe(TOPIC_CONFIG, 1);
+  if (rptWanted && !rptPending) requestRptInterval();
+}
 
-  return qtClient.connected();
+/*********************************************************************************************************************
+linkDown(): called by the link when the connection is lost: red LED on; publishers queue until linkUp()
+parameters: none
+returns: void
+**********************************************************************************************************************/
+void linkDown() {
+  fn_RedLed(ON);
+  Serial.println("MQTT connection lost");
+  linkDrops++;
+  rptPending = false;  // asked again on reconnecting
 }
+
 /********************************************************************************************************************
-publishMQTT(): post CSV data, including initial character and CSV-style requests to Shed
+publishMQTT(): queue CSV data, including initial character and CSV-style requests to Shed
 parameters:
   init: bool: if initial request for report interval value
   star: bool: true if WD star CSV, otherwise false
   csv: string containing CSV data: NB MUST start with comma and no final comma
-returns: void
+returns: bool: true if queued
 *********************************************************************************************************************/
-void publishMQTT(bool init, bool star, const char* csv) {
+bool publishMQTT(bool init, bool star, const char* csv) {
   char buf[STARBUF_LEN];  // STARBUF_LEN is currently > BUF_LEN, so use bigger buffer
   int len = strlen(csv);
+  if (len + 2 > STARBUF_LEN) return false;  // '$', csv and its terminator must fit
   buf[0] = '$';
   strcpy(buf + 1, csv);
   if (init) {
-    qtClient.publish(TOPIC_INIT, buf, false);
-    return;
+    return out.put(LANE_DATA, TOPIC_INIT, buf);
   }
-  if (star) qtClient.publish(TOPIC_STAR, buf, false);
-  else qtClient.publish(TOPIC_CSV, buf, false);
+  if (star) return out.put(LANE_DATA, TOPIC_STAR, buf);
+  else return out.put(LANE_DATA, TOPIC_CSV, buf);
 }
 
 /********************************************************************************************************************
-postMessage(): post message verbatim, just adding 'M' to the front
+postMessage(): queue message verbatim, just adding '$' to the front (diagnostics lane: dropped if full)
 parameters:
   txt: string containing message
 returns: void
@@ -158,7 +225,20 @@ void postMessage(const char* txt) {
   char buf[BUF_LEN];
   buf[0] = '$';
   strcpy(buf + 1, txt);
-  qtClient.publish(TOPIC_MESS, buf, false);
+  out.put(LANE_DIAG, TOPIC_MESS, buf);
+}
+
+/********************************************************************************************************************
+qtPublish(): publishes a payload, timing it for the metrics; only called by out.drain()
+parameters: topic: const char*, payload: const uint8_t*, len: unsigned int
+returns: bool: true if published
+*********************************************************************************************************************/
+bool qtPublish(const char* topic, const uint8_t* payload, unsigned int len) {
+  uint32_t t0 = (uint32_t)esp_timer_get_time();
+  bool ok = qtClient.publish(topic, payload, len, false);
+  zoneMetrics.add(MT_PUB, (uint32_t)esp_timer_get_time() - t0);
+  link.published(ok);
+  return ok;
 }
 // BEGIN NTP ===================================================================================================================
 
@@ -168,95 +248,6 @@ NTPClient timeClient(ntpUDP);
 
 // END NTP =====================================================================================================================
 
-// BEGIN OTA ===================================================================================================================
-
-/*
- * Login page
- */
-const char* loginIndex =
-  "<form name='loginForm'>"
-  "<table width='20%' bgcolor='A09F9F' align='center'>"
-  "<tr>"
-  "<td colspan=2>"
-  "<center><font size=4><b>ESP32 Login Page</b></font></center>"
-  "<br>"
-  "</td>"
-  "<br>"
-  "<br>"
-  "</tr>"
-  "<td>Username:</td>"
-  "<td><input type='text' size=25 name='userid'><br></td>"
-  "</tr>"
-  "<br>"
-  "<br>"
-  "<tr>"
-  "<td>Password:</td>"
-  "<td><input type='Password' size=25 name='pwd'><br></td>"
-  "<br>"
-  "<br>"
-  "</tr>"
-  "<tr>"
-  "<td><input type='submit' onclick='check(this.form)' value='Login'></td>"
-  "</tr>"
-  "</table>"
-  "</form>"
-  "<script>"
-  "function check(form)"
-  "{"
-  "if(form.userid.value=='MIS' && form.pwd.value=='mispas')"
-  "{"
-  "window.open('/serverIndex')"
-  "}"
-  "else"
-  "{"
-  " alert('Error Password or Username')/*displays error message*/"
-  "}"
-  "}"
-  "</script>";
-
-/*
- * Server Index Page
- */
-
-const char* serverIndex =
-  "<script src='https://ajax.googleapis.com/ajax/libs/jquery/3.2.1/jquery.min.js'></script>"
-  "<form method='POST' action='#' enctype='multipart/form-data' id='upload_form'>"
-  "<input type='file' name='update'>"
-  "<input type='submit' value='Update'>"
-  "</form>"
-  "<div id='prg'>progress: 0%</div>"
-  "<script>"
-  "$('form').submit(function(e){"
-  "e.preventDefault();"
-  "var form = $('#upload_form')[0];"
-  "var data = new FormData(form);"
-  " $.ajax({"
-  "url: '/update',"
-  "type: 'POST',"
-  "data: data,"
-  "contentType: false,"
-  "processData:false,"
-  "xhr: function() {"
-  "var xhr = new window.XMLHttpRequest();"
-  "xhr.upload.addEventListener('progress', function(evt) {"
-  "if (evt.lengthComputable) {"
-  "var per = evt.loaded / evt.total;"
-  "$('#prg').html('progress: ' + Math.round(per*100) + '%');"
-  "}"
-  "}, false);"
-  "return xhr;"
-  "},"
-  "success:function(d, s) {"
-  "console.log('success!')"
-  "},"
-  "error: function (a, b, c) {"
-  "}"
-  "});"
-  "});"
-  "</script>";
-
-// END OTA =====================================================================================================================
-
 // -----------------------------------------------------------------------------------------------------------------------------
 void setup() {
   //Setup code here, to run once:
@@ -267,10 +258,22 @@ void setup() {
 
   fn_RedLed(ON);
 
+  unsigned long tBoot = millis();  // boot phase timings, posted by logBootTimes()
   kom.begin();
+  unsigned long tWifi = millis();
   wi.begin();
-
-  tryMQTTStart();
+  if (!rlog.begin()) Serial.println("Record log unavailable: reports will be lost while MQTT is down");
+  wi.setSeq(rlog.nextSeq());
+  rlog.saveSeq(rlog.nextSeq() + SEQ_BLOCK);
+  if (kom.getRptIntvl() > 0) rptIntvl = nextRptIntvl = kom.getRptIntvl();  // warm start: last one sent
+  cfgNext.id = 0;
+  cfgNext.rptIntvl = nextRptIntvl;
+  cfgNext.blink = blinkLoops;
+  wi.getConfig(cfgNext);
+  unsigned long tInputs = millis();
+
+  startMQTT();
+  unsigned long tMqtt = millis();
 
   // OTA START ================================================================================================
   /*use mdns for host name resolution*/
@@ -281,126 +284,190 @@ void setup() {
     }
   }
   Serial.println("mDNS responder started");
-  /*return index page which is stored in serverIndex */
-  server.on("/", HTTP_GET, []() {
-    server.sendHeader("Connection", "close");
-    server.send(200, "text/html", loginIndex);
-  });
-  server.on("/serverIndex", HTTP_GET, []() {
-    server.sendHeader("Connection", "close");
-    server.send(200, "text/html", serverIndex);
-  });
-  /*handling uploading firmware file */
-  server.on(
-    "/update", HTTP_POST, []() {
-      server.sendHeader("Connection", "close");
-      server.send(200, "text/plain", (Update.hasError()) ? "FAIL" : "OK");
-      ESP.restart();
-    },
-    []() {
-      HTTPUpload& upload = server.upload();
-      if (upload.status == UPLOAD_FILE_START) {
-        Serial.printf("Update: %s\n", upload.filename.c_str());
-        if (!Update.begin(UPDATE_SIZE_UNKNOWN)) {  //start with max available size
-          Update.printError(Serial);
-        }
-      } else if (upload.status == UPLOAD_FILE_WRITE) {
-        /* flashing firmware to ESP*/
-        if (Update.write(upload.buf, upload.currentSize) != upload.currentSize) {
-          Update.printError(Serial);
-        }
-      } else if (upload.status == UPLOAD_FILE_END) {
-        if (Update.end(true)) {  //true to set the size to the current progress
-          Serial.printf("Update Success: %u\nRebooting...\n", upload.totalSize);
-        } else {
-          Update.printError(Serial);
-        }
-      }
-    });
-  server.begin();
+  ota.begin();  // the update page and upload handler: see OtaServer.h
 
   // OTA END ==================================================================================================
-  
-  // MQTT running; timeClient object about to be used for the first time
-  postMessage("About to start NTP request");
+  unsigned long tOta = millis();
 
-  // Set reboot countdown
+  // NTP and the report interval are finished off by the network task: see checkStartup()
   timeClient.begin();
   timeClient.setTimeOffset(0);  // UTC
-  int waitCount = 50;
-  bool updated = false;
-  while (waitCount > 0) {
-    if (timeClient.update()) {
-      updated = true;
-      break;
-    }
-    delay(10);
-    waitCount--;
-  }
-
-  int hrTime = 0; // default to 00:00 if no NTP
-  if (updated) hrTime = timeClient.getHours();
-  rebootTime = millis() + 1000 * 3600 * (24 - hrTime); // milliseconds
-  postMessage("NTP task now completed");
-
-  qtClient.subscribe(TOPIC_SETUP, 1);
+  lastNtpTry = millis() - NTP_RETRY;         // first try straight away
   loopCount = 0;
-  requestRptInterval();
 
-  qtClient.unsubscribe(TOPIC_SETUP);
   logStartupSuccess();
+  logBootTimes(tWifi - tBoot, tInputs - tWifi, tMqtt - tInputs, tOta - tMqtt, millis() - tBoot);
+  startLightSleep();
   fn_RedLed(OFF);
+
+  // Sampling gets a core to itself so it keeps time whatever the network is doing
+  xTaskCreatePinnedToCore(sampleTask, "sample", SAMPLE_STACK, NULL, SAMPLE_PRIO, &sampleHandle, SAMPLE_CORE);
+  xTaskCreatePinnedToCore(netTask, "net", NET_STACK, NULL, NET_PRIO, &netHandle, NET_CORE);
+  xTaskCreatePinnedToCore(otaTask, "ota", OTA_STACK, NULL, OTA_PRIO, &otaHandle, OTA_CORE);
+  mem.watch(MW_SAMPLE, sampleHandle);
+  mem.watch(MW_NET, netHandle);
+  mem.watch(MW_OTA, otaHandle);
 }
 
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 
 void loop() {
+  vTaskDelete(NULL);  // nothing left for the Arduino loop task: see sampleTask() and netTask()
+}
+
+/*****************************************************************************************************
+sampleTask(): runs sampleTick() every LOOP_TIME, measured from when each tick was due (no drift)
+parameters: param: void*: unused
+returns: void (never returns)
+*****************************************************************************************************/
+void sampleTask(void* param) {
+  TickType_t lastWake = xTaskGetTickCount();
+  for (;;) {
+    sampleTick();
+    vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(LOOP_TIME));
+  }
+}
+
+/*****************************************************************************************************
+sampleTick(): one 1/4 second sampling pass: everything that used to run in loop() except comms
+parameters: none
+returns: void
+*****************************************************************************************************/
+void sampleTick() {
   int flag = 0;
-  //unsigned long m1, m2, z1 = 0ul, z2 = 0ul, z3 = 0ul, z4 = 0ul, z5 = 0ul;
-  server.handleClient();  // OTA
+  report rep;
+  runConfig cfg;
+  char mBuf[BUF_LEN];
+  uint32_t t0 = (uint32_t)esp_timer_get_time();
   loopStart = millis();
-  qtClient.loop();  // keep MQTT going
   // Loop timing zones start here
 
   // ZONE 1: EVERY LOOP (1/4 sec) -----------------------------------------------------------------
+  ZONE_MARK(ZS_SAMPLE, ZT_EVERY);
   wi.updateMaxGust();                          // 4 times/sec to catch gusts
-  flag = wi.updateMeteo(loopCount, rptIntvl);  // updateMeteo uses loopCount to decide when to update each Meteo
+  wi.updateMeteo();                            // samples each meteo item on its own period
+  ZONE_MARK(ZS_SAMPLE, ZT_I2C);
+  wi.pollSensors();                            // I2C conversions: started or collected, never waited for
   // END ZONE 1 -----------------------------------------------------------------------------------
 
   //ZONE 4: EVERY 4 LOOPS (1 sec) ---------------------------------------------------------
   if ((loopCount % ZONE4) == 0) {
-    wi.WDChanged(false);  // updates the set of 32 values used to produce WD stats
+    ZONE_MARK(ZS_SAMPLE, ZT_WD);
+    wi.WDChanged();  // updates the set of 32 values used to produce WD stats
+    if (wi.updateProfile()) rptIntvl = wi.profileLoops(nextRptIntvl);  // moving up can end this interval now
+    while (wi.sensorNews(mBuf, BUF_LEN - 2)) queueMessage(mBuf);       // I2C devices down or back
     flag = flag | 256;
-    //shedRequested();  // responds to any shed messages received (hourly)
   }
-
   // END ZONE 4 -----------------------------------------------------------------------------------
 
-  // ZONE 12: EVERY 12 LOOPS (3 secs) -------------------------------------------------------------
-  if ((loopCount % ZONE12) == 0) {
-    if (!qtReconnect()) {  // checks connection and attempts retry if none
-      postMessage("MQTT failed");
-    }
+  // ZONE 12: EVERY 12 LOOPS (3 secs; blinkLoops) -----------------------------------------------
+  if ((loopCount % blinkLoops) == 0) {
+    ZONE_MARK(ZS_SAMPLE, ZT_BLINK);
     blink();  // "normal" 3 second blink
     flag = flag | 512;
   }
   // END ZONE 12 ----------------------------------------------------------------------------------
 
-  // ZONE SLOWEST: EVERY rptInterval LOOPS (DEFAULT 30 secs)
+  // ZONE SLOWEST: EVERY rptInterval LOOPS (DEFAULT 30 secs): hand the interval to the network task
   if (loopCount == 0) {
-    if (millis() > rebootTime) {
-      esp_restart();
-    }
-    wi.WDChanged(true);
-    getAndPostCSV();
+    ZONE_MARK(ZS_SAMPLE, ZT_REPORT);
+    wi.WDChanged();
+    wi.getReport(rep);
     wi.resetAll();
-    kom.checkWifi();
+    if (!reportQ.push(rep)) queueMessage("Report queue full");
+    if (cfgQ.pop(cfg)) applyConfig(cfg);       // settings changes start with an interval
+    rptIntvl = wi.profileLoops(nextRptIntvl);  // the Shed's interval, scaled for the weather
   }
   //Loop timing zones end here--------------------------------------------------------------------
 
+  ZONE_MARK(ZS_SAMPLE, ZT_IDLE);
+  zoneMetrics.add(MT_LOOP, (uint32_t)esp_timer_get_time() - t0);
   loopTimer(flag);
-  loopCount = (loopCount + 1) % rptIntvl;
-  // END OF LOOP
+  loopCount = (loopCount + 1 >= rptIntvl) ? 0 : loopCount + 1;
+}
+
+/*****************************************************************************************************
+netTask(): runs netTick() every NET_TICK milliseconds on the other core from sampling
+parameters: param: void*: unused
+returns: void (never returns)
+*****************************************************************************************************/
+void netTask(void* param) {
+  for (;;) {
+    netTick();
+    vTaskDelay(pdMS_TO_TICKS(NET_TICK));
+  }
+}
+
+/*****************************************************************************************************
+otaTask(): runs otaTick() every OTA_TICK milliseconds, whenever the network task is waiting
+parameters: param: void*: unused
+returns: void (never returns)
+*****************************************************************************************************/
+void otaTask(void* param) {
+  for (;;) {
+    otaTick();
+    vTaskDelay(pdMS_TO_TICKS(OTA_TICK));
+  }
+}
+
+/*****************************************************************************************************
+otaTick(): serves the update page and takes uploads: a whole upload happens inside one call, paced
+           by OtaServer so that neither MQTT nor sampling waits on it
+parameters: none
+returns: void
+*****************************************************************************************************/
+void otaTick() {
+  ota.handle();
+}
+
+/*****************************************************************************************************
+netTick(): MQTT upkeep and posting of whatever the sampling and OTA tasks have queued.
+           Blocking here (reconnects, slow broker) never holds up sampling.
+parameters: none
+returns: void
+*****************************************************************************************************/
+void netTick() {
+  report rep;
+  message msg;
+  ZONE_MARK(ZS_NET, link.isUp() ? ZT_MQTT : ZT_RECONNECT);
+  link.tick(millis());  // keeps MQTT going, or one connect attempt when the backoff is over
+
+  ZONE_MARK(ZS_NET, ZT_PUBLISH);
+  while (msgQ.pop(msg)) postMessage(msg.txt);
+  while (ota.getNews(msg.txt, BUF_LEN - 2)) postMessage(msg.txt);
+  if (ota.restartDue() && !rebootWanted) {  // after the next interval has gone, like a MemWatch reboot
+    rebootWanted = true;
+    rebootAt = millis();
+  }
+  while (reportQ.pop(rep)) {
+    if (rep.seq + 1 >= rlog.nextSeq()) rlog.saveSeq(rep.seq + 1 + SEQ_BLOCK);
+    if (BATCH_COUNT > 1) {
+      batchReport(rep);
+    } else if (!link.isUp() || (rlog.count() > 0) || !postReport(rep)) {  // nothing new goes out ahead of the log
+      rlog.append(rep);
+    }
+    if (rebootWanted) rebootNow = true;  // only ever straight after an interval has been posted or logged
+    kom.checkWifi();
+  }
+  if (batch.due(millis())) postBatch();
+  checkStartup();
+  if (bNewConfig) checkConfig();
+  while (appliedQ.pop(cfgEcho)) {
+    kom.saveRptIntvl(cfgEcho.rptIntvl);
+    bEchoDue = true;
+  }
+  if (bEchoDue && postConfig(cfgEcho)) bEchoDue = false;
+  if (millis() - lastMetrics >= METRICS_MS) {
+    lastMetrics = millis();
+    postMetrics();
+    postHealth();
+  }
+  if (link.isUp()) {
+    out.drain(qtPublish, OUT_PER_TICK);
+    if (out.count(LANE_DATA) == 0) replayLog();  // the log follows whatever was already queued
+  }
+  checkReboot();
+  ZONE_MARK(ZS_NET, ZT_IDLE);
 }
 
 /*****************************************************************************************************/
@@ -408,51 +475,32 @@ void loop() {
 // Global setup methods ------------------------------------------------------------------------------
 
 /*****************************************************************************************************
-a. tryMQTTStart(): attempts to start MQTT connection: reboots ESP after 10 failed attempts
+a. startMQTT(): sets up MQTT and makes the first connect attempt; if the broker is not there, setup
+   carries on and the network task keeps trying (reports wait in the record log meanwhile)
 parameters: none
 returns: void
 *****************************************************************************************************/
-void tryMQTTStart() {
-  int qtCount = 0;
-  while (!qtSetup(kom.getNwkIx())) {
-    fn_RedLed(ON);
-    Serial.println("MQTT setup failed. No MQTT comms. Check RPi is powered and running.");
-    digitalWrite(LEDPin, !digitalRead(LEDPin));
-    delay(800);
-    if (qtCount++ == 11) esp_restart();
-  }
-  fn_RedLed(OFF);
+void startMQTT() {
+  qtSetup(kom.getNwkIx());
+  link.tick(millis());
+  if (!link.isUp()) Serial.println("MQTT setup failed. Check RPi is powered and running: retrying in the background.");
 }
 
 /*****************************************************************************************************
-b. requestRptInterval(): sends message to Shed to prompt repeat Interval value by return
+b. requestRptInterval(): sends message to Shed to prompt repeat Interval value by return; the reply
+   is picked up by checkStartup(). Called by linkUp() until the Shed has answered.
 parameters: none
 returns: void
 *****************************************************************************************************/
 void requestRptInterval() {
   // format and post initial reQuest string
-  int i;
   char buf[BUF_LEN];
   sprintf(buf, "%02d", wi.getA7());
   buf[2] = '\0';
+  qtClient.subscribe(TOPIC_SETUP, 1);
   publishMQTT(true, false, buf);
-  char ch;
-  bool bContinue = true;
-  int loops = 0;
-  while (bContinue && (loops < INIT_WAIT)) {
-    qtClient.loop();
-    if (bNewMQTT) {  // 'I' == initial Shed information message
-      ch = qticBuf[0];
-      //Serial.print(ch);
-      rptIntvl = atoi(qticBuf + 1);
-      Serial.print("Rpt Intvl: ");
-      Serial.println(rptIntvl);
-      bNewMQTT = false;
-      bContinue = false;
-    }
-    loops++;
-    delay(100);  // Review this interval once Python code is written!
-  }
+  rptPending = true;
+  rptAskedAt = millis();
 }
 
 /*****************************************************************************************************
@@ -471,6 +519,77 @@ void logStartupSuccess() {
   versionBuf[30] = '\0';  // truncate for all later uses
 }
 
+/*****************************************************************************************************
+d. startLightSleep(): power management (LIGHT_SLEEP builds only): the CPU clock drops to PM_MIN_MHZ while
+   both tasks wait, and the chip light-sleeps whenever no driver holds a PM lock. The PCNT driver holds
+   one while its glitch filter is on, so the counters never stop; the saving is then the lower clock.
+parameters: none
+returns: void
+*****************************************************************************************************/
+void startLightSleep() {
+#if LIGHT_SLEEP && defined(CONFIG_PM_ENABLE)
+  esp_pm_config_t pm = {};
+  pm.max_freq_mhz = PM_MAX_MHZ;
+  pm.min_freq_mhz = PM_MIN_MHZ;
+  pm.light_sleep_enable = true;
+  if (esp_pm_configure(&pm) != ESP_OK) postMessage("Light sleep not available");
+#elif LIGHT_SLEEP
+  postMessage("Light sleep needs CONFIG_PM_ENABLE: not started");
+#endif
+}
+
+/*****************************************************************************************************
+e. logBootTimes(): posts how long each phase of setup() took
+parameters: wifi, inputs, mqtt, ota, total: unsigned long: milliseconds
+returns: void
+*****************************************************************************************************/
+void logBootTimes(unsigned long wifi, unsigned long inputs, unsigned long mqtt, unsigned long ota, unsigned long total) {
+  char buf[BUF_LEN];
+  snprintf(buf, BUF_LEN - 2, "Boot ms: wifi %lu (%s), inputs %lu, mqtt %lu, ota %lu, total %lu", wifi,
+           kom.isWarm() ? "warm" : "scan", inputs, mqtt, ota, total);
+  postMessage(buf);
+}
+
+/*****************************************************************************************************
+f. checkStartup(): network task: takes the Shed's reply to requestRptInterval() (or gives up after
+   INIT_WAIT tenths of a second) and keeps trying NTP until it answers. The reply's interval goes to
+   the sampling task through cfgQ, on top of any TOPIC_CONFIG settings already taken, and is echoed
+   and saved like them
+parameters: none
+returns: void
+*****************************************************************************************************/
+void checkStartup() {
+  if (rptPending && bNewMQTT) {  // 'I' == initial Shed information message
+    runConfig cfg = cfgNext;  // the reply is a settings change like any other, so no TOPIC_CONFIG one undoes it
+    cfg.rptIntvl = atoi(qticBuf + 1);
+    bool good = (qticBuf[0] == 'I') && (cfg.rptIntvl >= ZONE4) && (cfg.rptIntvl <= CFG_RPT_MAX);  // as parseConfig()
+    if (!good || cfgQ.push(cfg)) {  // cfgQ is only ever full until the next interval boundary: else next tick
+      if (good) {
+        cfgNext = cfg;
+        Serial.print("Rpt Intvl: ");
+        Serial.println(cfg.rptIntvl);
+      } else if (qticBuf[0] == 'I') {
+        postMessage("Bad report interval from Shed");
+      }
+      bNewMQTT = false;
+      rptPending = rptWanted = false;
+      qtClient.unsubscribe(TOPIC_SETUP);
+    }
+  } else if (rptPending && (millis() - rptAskedAt > INIT_WAIT * 100UL)) {
+    rptPending = rptWanted = false;
+    qtClient.unsubscribe(TOPIC_SETUP);
+    postMessage("No report interval from Shed");
+  }
+
+  if (!ntpDone && (millis() - lastNtpTry >= NTP_RETRY)) {
+    lastNtpTry = millis();
+    if (timeClient.update()) {
+      ntpDone = true;
+      postMessage("NTP time received");
+    }
+  }
+}
+
 // Global loop methods -------------------------------------------------------------------------------
 
 /*****************************************************************************************************
@@ -502,44 +621,310 @@ void fn_RedLed(int state) {
 }
 
 /************************************************************************************************************
-3. getAndPostCSV(): gathers CSV data and posts to Shed (and resets counters/max)
-parameters: none
-returns: void
+3. postReport(): queues one interval's data in the configured format(s): all of it or none
+parameters: rep: const report&: the interval from the sampling task (or the record log)
+returns: bool: true if every message was queued
 *************************************************************************************************************/
-void getAndPostCSV() {
-  char freqBuf[BUF_LEN];
+bool postReport(const report& rep) {
+  outMark m = out.mark(LANE_DATA);
+  bool ok = true;
+  if (TELEM_FORMAT != TELEM_BIN) ok = getAndPostCSV(rep);
+  if (ok && (TELEM_FORMAT != TELEM_CSV)) ok = postBinary(rep);
+  if (!ok) out.rollback(LANE_DATA, m);
+  return ok;
+}
+
+/************************************************************************************************************
+3a. getAndPostCSV(): formats one interval's data as CSV and queues it for the Shed, with the sampled
+    items' spread on TOPIC_STATS and the WD summary and profile tag on TOPIC_WIND (the star only while
+    STAR_PAYLOAD is set)
+parameters: rep: const report&: the interval from the sampling task
+returns: bool: true if all of it was queued
+*************************************************************************************************************/
+bool getAndPostCSV(const report& rep) {
+  char freqBuf[FREQBUF_LEN];
   char starBuf[STARBUF_LEN];
   int sum;
   float revs;
-  sum = wi.getStarCSV(starBuf);
-  publishMQTT(false, true, starBuf);
+  sum = WInputs::getStarCSV(rep, starBuf);
+  if (STAR_PAYLOAD && !publishMQTT(false, true, starBuf)) return false;
   Serial.println(starBuf);  // TEMP
-  revs = wi.getFreqCSV(freqBuf);
-  publishMQTT(false, false, freqBuf);
+  revs = WInputs::getFreqCSV(rep, freqBuf);
+  if (!publishMQTT(false, false, freqBuf)) return false;
   if ((int)revs != sum) {
     char buf[BUF_LEN];
-    sprintf(buf, "Unequal revs: %d (revs): %d (sum)", revs, sum);
+    sprintf(buf, "Unequal revs: %d (revs): %d (sum)", (int)revs, sum);
     postMessage(buf);
   }
-  wi.resetAll();
   Serial.println(freqBuf);  // TEMP
+  char windBuf[BUF_LEN];
+  int len = sprintf(windBuf, "$W%u", (unsigned)rep.seq);
+  WInputs::getWindCSV(rep, windBuf + len);
+  WInputs::getTagCSV(rep, windBuf + strlen(windBuf));
+  if (!out.put(LANE_DATA, TOPIC_WIND, windBuf)) return false;
+  char statsBuf[STATSBUF_LEN + 16];
+  len = sprintf(statsBuf, "$S%u", (unsigned)rep.seq);
+  if (WInputs::getStatsCSV(rep, statsBuf + len) > 0) return out.put(LANE_DATA, TOPIC_STATS, statsBuf);
+  return true;
 }
 
-/******************************************************************************************************
-4. loopTimer(): aims to keep loop time to 1/4 second intervals: logs message if code runs longer
+/************************************************************************************************************
+3b. postBinary(): queues one interval's data in the compact binary format (see Telemetry.h)
+parameters: rep: const report&: the interval from the sampling task
+returns: bool: true if queued
+*************************************************************************************************************/
+bool postBinary(const report& rep) {
+  uint8_t buf[BIN_LEN];
+  int len = Telemetry::encode(rep, BIN_REPORT, buf, BIN_LEN);
+  return (len > 0) && out.put(LANE_DATA, TOPIC_BIN, buf, len);
+}
+
+/************************************************************************************************************
+3c. replayLog(): called once the data lane is empty, so everything queued from the log last time has been
+    published: drops that from the log, then queues up to LOG_BATCH more, oldest first. Nothing leaves the
+    flash before it has gone out; a restart in between only sends those reports twice.
+parameters: none
+returns: void
+*************************************************************************************************************/
+void replayLog() {
+  report rep;
+  if (replayed > 0) {
+    uint32_t done = replayFrom + replayed;  // the log may have lost some of them to overflow since
+    while ((rlog.count() > 0) && ((int32_t)(done - rlog.tail()) > 0)) rlog.drop();
+    replayed = 0;
+    if (rlog.count() == 0) {
+      char buf[BUF_LEN];
+      sprintf(buf, "Record log replayed up to seq %u; %u lost", (unsigned)replaySeq, (unsigned)rlog.lost());
+      postMessage(buf);
+    }
+  }
+  replayFrom = rlog.tail();
+  while ((replayed < LOG_BATCH) && rlog.peek(rep, replayed) && postReport(rep)) {
+    replaySeq = rep.seq;
+    replayed++;
+  }
+}
+
+/************************************************************************************************************
+3d. batchReport(): adds one interval to the current batch, posting the batch first if it is full
+parameters: rep: const report&: the interval from the sampling task
+returns: void
+*************************************************************************************************************/
+void batchReport(const report& rep) {
+  if (rlog.count() > 0) {  // nothing new goes out ahead of the log
+    rlog.append(rep);
+    return;
+  }
+  if (!batch.add(rep, millis())) {
+    postBatch();
+    batch.add(rep, millis());
+  }
+}
+
+/************************************************************************************************************
+3e. postBatch(): queues the current batch as one message on TOPIC_BATCH; if the link is down or there is
+    no room its reports go to the record log, to be replayed one by one
+parameters: none
+returns: void
+*************************************************************************************************************/
+void postBatch() {
+  int len = batch.finish(millis(), batchBuf, sizeof(batchBuf));
+  if ((len <= 0) || !link.isUp() || !out.put(LANE_DATA, TOPIC_BATCH, batchBuf, len)) {
+    for (int i = 0; i < batch.count(); i++) rlog.append(batch.get(i));
+  }
+  batch.clear();
+}
+
+/************************************************************************************************************
+3f. postMetrics(): posts each zone's, whole loops' and publishes' latency since the last time on
+    TOPIC_METRICS: "$M<secs>" then ",<name>,<count>,<p50>,<p99>,<max>" (usecs) for each; and a message
+    if the outbound queue has had to turn anything away since the last time
+parameters: none
+returns: void
+*************************************************************************************************************/
+void postMetrics() {
+  static uint32_t lastDrops = 0;
+  char buf[METRICS_LEN];
+  int len = sprintf(buf, "$M%d", METRICS_MS / 1000);
+  if (zoneMetrics.getCSV(buf + len, METRICS_LEN - len) > 0) out.put(LANE_DIAG, TOPIC_METRICS, buf);
+  if (out.dropped(LANE_DATA) + out.dropped(LANE_DIAG) != lastDrops) {
+    lastDrops = out.dropped(LANE_DATA) + out.dropped(LANE_DIAG);
+    snprintf(buf, BUF_LEN - 2, "Outq data %u sent %u logged pk %d; diag %u sent %u dropped pk %d",
+             (unsigned)out.sent(LANE_DATA), (unsigned)out.dropped(LANE_DATA), out.peak(LANE_DATA),
+             (unsigned)out.sent(LANE_DIAG), (unsigned)out.dropped(LANE_DIAG), out.peak(LANE_DIAG));
+    postMessage(buf);
+  }
+}
+
+/************************************************************************************************************
+3g. postHealth(): posts heap and stack headroom on TOPIC_HEALTH: "$H<uptime secs>,<free>,<largest>,<min free>,
+    <drift>,sample,<spare>,net,<spare>,ota,<spare>" (bytes: see MemWatch.h) then ",upd,<tried>,<failed>,
+    <last ms>" (firmware updates); asks for a reboot once headroom runs low
+parameters: none
+returns: void
+*************************************************************************************************************/
+void postHealth() {
+  char buf[BUF_LEN];
+  char why[ICSV_LEN * 3];
+  mem.sample();
+  int len = sprintf(buf, "$H%lu", millis() / 1000);
+  len += mem.getCSV(buf + len, BUF_LEN - len);
+  ota.getCSV(buf + len, BUF_LEN - len);
+  out.put(LANE_DIAG, TOPIC_HEALTH, buf);
+  if (!rebootWanted && mem.rebootDue(why, sizeof(why))) {
+    rebootWanted = true;
+    rebootAt = millis();
+    snprintf(buf, BUF_LEN - 2, "Reboot due: %s", why);
+    postMessage(buf);
+  }
+}
+
+/************************************************************************************************************
+3h. checkReboot(): reboots when postHealth() or a new image has asked for it and an interval has been posted
+    or logged since, once everything queued has gone out (or REBOOT_WAIT after asking, if the broker is not
+    taking it); never in the middle of an upload
 parameters: none
 returns: void
+*************************************************************************************************************/
+void checkReboot() {
+  if (!rebootWanted || ota.busy()) return;
+  bool sent = (out.count(LANE_DATA) + out.count(LANE_DIAG)) == 0;
+  if (rebootNow && (sent || (millis() - rebootAt > REBOOT_WAIT))) esp_restart();
+}
+
+/******************************************************************************************************
+4. loopTimer(): checks the sampling pass fitted in its 1/4 second slot: queues a message if not.
+   No waiting here any more: sampleTask() sleeps until the next tick is due.
+parameters: flag: int: which zones ran this pass
+returns: void
 ******************************************************************************************************/
 void loopTimer(int flag) {
   // End-of-loop timing code
   unsigned long loopEnd = millis();
   if ((loopEnd - loopStart) > LOOP_TIME) {  // Code took > LOOP_TIME
     char mBuf[BUF_LEN];
-    sprintf(mBuf, "Long loop time %u; Flag:%x", loopEnd - loopStart, flag);
-    postMessage(mBuf);  // log all long loops (> LOOP_TIME)
-  } else {              // wait until LOOP_TIME has elapsed
-    while (millis() - loopStart < LOOP_TIME) {
-      delay(1);
+    sprintf(mBuf, "Long loop time %lu; Flag:%x", loopEnd - loopStart, flag);
+    queueMessage(mBuf);  // log all long loops (> LOOP_TIME)
+  }
+}
+
+/******************************************************************************************************
+5. queueMessage(): passes a message from the sampling task to the network task for posting
+parameters: txt: const char*: the message
+returns: void
+******************************************************************************************************/
+void queueMessage(const char* txt) {
+  message msg;
+  strncpy(msg.txt, txt, BUF_LEN - 2);  // postMessage() adds the '$'
+  msg.txt[BUF_LEN - 2] = '\0';
+  msgQ.push(msg);
+}
+
+/******************************************************************************************************
+6. checkConfig(): network task: takes a TOPIC_CONFIG message, on top of the last change taken, and
+   queues it for the next interval boundary; a bad one is reported on TOPIC_MESS and nothing changes
+parameters: none
+returns: void
+******************************************************************************************************/
+void checkConfig() {
+  char buf[BUF_LEN];
+  char why[ICSV_LEN * 4];
+  runConfig cfg = cfgNext;
+  bNewConfig = false;
+  if (cfgLen == 0) return;  // the retained settings have been cleared: the ones in force stay
+  if (cfgLen >= CFG_LEN) {
+    snprintf(why, sizeof(why), "%u bytes", cfgLen);
+  } else if (parseConfig(cfgBuf, cfg, why, sizeof(why))) {
+    if (cfgQ.push(cfg)) {
+      cfgNext = cfg;
+      return;
+    }
+    strcpy(why, "queue full");
+  }
+  snprintf(buf, BUF_LEN - 2, "Config rejected: %s", why);
+  postMessage(buf);
+}
+
+/******************************************************************************************************
+6a. parseConfig(): reads "key=value,..." settings. Keys: id (any number, echoed back), rpt (report
+    interval, loops), blink (loops between blinks), prof (A: the weather picks, or C, N or S: pinned),
+    items (hex mask of items reported, bit per METEO_ITEMS item) and any sampled item's name (e.g. Tp:
+    its sampling period, msecs). All of it or none: cfg is only usable if this returns true.
+parameters: txt: char*: the payload (cut up here), cfg: runConfig&: settings to change, why: char*: receives
+            the first bad setting, len: int: its size
+returns: bool: true if every setting was good
+******************************************************************************************************/
+bool parseConfig(char* txt, runConfig& cfg, char* why, int len) {
+  char* save = NULL;
+  for (char* key = strtok_r(txt, ",", &save); key != NULL; key = strtok_r(NULL, ",", &save)) {
+    char* val = strchr(key, '=');
+    if (val == NULL) {
+      snprintf(why, len, "%s", key);
+      return false;
+    }
+    *val++ = '\0';
+    char* end;
+    long n = strtol(val, &end, (strcmp(key, "items") == 0) ? 16 : 10);
+    bool num = (*val != '\0') && (*end == '\0');
+    bool ok = false;
+    if (strcmp(key, "id") == 0) {
+      ok = num;
+      cfg.id = (int)n;
+    } else if (strcmp(key, "rpt") == 0) {
+      ok = num && (n >= ZONE4) && (n <= CFG_RPT_MAX);
+      cfg.rptIntvl = (int)n;
+    } else if (strcmp(key, "blink") == 0) {
+      ok = num && (n >= ZONE4) && (n <= ZONE0);
+      cfg.blink = (int)n;
+    } else if (strcmp(key, "items") == 0) {
+      ok = num && (n >= 0) && (n <= ITEMS_ALL);
+      cfg.enabled = (uint16_t)n;
+    } else if (strcmp(key, "prof") == 0) {
+      const char* tags = PROF_TAGS "A";
+      const char* p = (val[0] != '\0') ? strchr(tags, val[0]) : NULL;
+      ok = (p != NULL) && (val[1] == '\0');
+      if (ok) cfg.profile = (val[0] == 'A') ? PROF_AUTO : (int)(p - tags);
+    } else {
+      for (int i = 0; i < NUM_ITEMS; i++) {
+        if (strcmp(key, itemNames[i]) != 0) continue;
+        ok = num && (itemPeriods[i] > 0) && (n >= LOOP_TIME) && ((unsigned long)n <= CFG_PERIOD_MAX);
+        cfg.period[i] = (unsigned long)n;
+      }
     }
+    if (!ok) {
+      snprintf(why, len, "%s=%s", key, val);
+      return false;
+    }
+  }
+  return true;
+}
+
+/******************************************************************************************************
+6b. applyConfig(): sampling task, at an interval boundary (after resetAll(), so no counts are lost):
+    puts settings into force and sends them back to be echoed
+parameters: cfg: const runConfig&: checked by parseConfig()
+returns: void
+******************************************************************************************************/
+void applyConfig(const runConfig& cfg) {
+  nextRptIntvl = cfg.rptIntvl;
+  blinkLoops = cfg.blink;
+  wi.setConfig(cfg);
+  if (!appliedQ.push(cfg)) queueMessage("Config applied: echo queue full");
+}
+
+/******************************************************************************************************
+6c. postConfig(): echoes applied settings on TOPIC_APPLIED, in the form TOPIC_CONFIG takes:
+    "id=<id>,rpt=<loops>,blink=<loops>,prof=<A|C|N|S>,items=<hex>" then "<item>=<msecs>" per sampled
+    item. On the data lane, so it is not dropped to make room for diagnostics.
+parameters: cfg: const runConfig&
+returns: bool: false if the outbox had no room (netTick() tries again, with the latest applied)
+******************************************************************************************************/
+bool postConfig(const runConfig& cfg) {
+  char buf[CFG_LEN];
+  int len = snprintf(buf, CFG_LEN, "id=%d,rpt=%d,blink=%d,prof=%c,items=%x", cfg.id, cfg.rptIntvl, cfg.blink,
+                     (cfg.profile == PROF_AUTO) ? 'A' : PROF_TAGS[cfg.profile], (unsigned)cfg.enabled);
+  for (int i = 0; (i < NUM_ITEMS) && (len < CFG_LEN); i++) {
+    if (itemPeriods[i] > 0) len += snprintf(buf + len, CFG_LEN - len, ",%s=%lu", itemNames[i], cfg.period[i]);
   }
+  return out.put(LANE_DATA, TOPIC_APPLIED, buf);
 }
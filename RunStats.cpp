@@ -0,0 +1,45 @@
+#include "RunStats.h"
+#include <math.h>
+
+/***********************************************************************************************
+* RunStats.cpp: RunStats class: Welford's method, so the mean and variance stay accurate in    *
+*               single precision however many samples arrive (the ESP32 has no double FPU)     *
+*                                                                                              *
+* Version: 0.1                                                                                 *
+* Last updated: 17/10/2026                                                                     *
+* Author: Jim Gunther                                                                          *
+*                                                                                              *
+***********************************************************************************************/
+
+RunStats::RunStats() {
+  reset();
+};
+
+/**************************************************************************************************
+add(): takes one sample
+parameters: x: float
+returns: void
+***************************************************************************************************/
+void RunStats::add(float x) {
+  if (_n == UINT16_MAX) return;
+  _n++;
+  float d = x - _mean;
+  _mean += d / _n;
+  _m2 += d * (x - _mean);
+  if ((_n == 1) || (x < _min)) _min = x;
+  if ((_n == 1) || (x > _max)) _max = x;
+}
+
+void RunStats::reset() {
+  _n = 0;
+  _mean = _m2 = _min = _max = 0.0f;
+}
+
+/**************************************************************************************************
+sd(): sample standard deviation
+parameters: none
+returns: float: 0 for fewer than 2 samples
+***************************************************************************************************/
+float RunStats::sd() {
+  return (_n < 2) ? 0.0f : sqrtf(_m2 / (_n - 1));
+}
@@ -0,0 +1,32 @@
+#ifndef RUN_STATS_H
+#define RUN_STATS_H
+#include <stdint.h>
+
+/***********************************************************************************************
+* RunStats.h: header file for RunStats class: running count, min, max, mean and standard       *
+*             deviation of a stream of samples, without keeping the samples                    *
+*                                                                                              *
+* Version: 0.1                                                                                 *
+* Last updated: 17/10/2026                                                                     *
+* Author: Jim Gunther                                                                          *
+*                                                                                              *
+***********************************************************************************************/
+class RunStats {
+  public:
+    RunStats();
+    void add(float x);
+    void reset();
+    uint16_t count() { return _n; }
+    float mean() { return _mean; }
+    float min() { return _min; }
+    float max() { return _max; }
+    float sd();
+
+  private:
+    uint16_t _n;
+    float _mean;
+    float _m2;  // sum of squared differences from the mean
+    float _min;
+    float _max;
+};
+#endif
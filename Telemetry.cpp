@@ -0,0 +1,169 @@
+#include "Telemetry.h"
+#include <math.h>
+#include <string.h>
+
+/***********************************************************************************************
+* Telemetry.cpp: Telemetry class: encodes a report as scaled fixed-point varints and a sparse  *
+*                WD star; no allocation, no float formatting                                   *
+*                                                                                              *
+* Version: 0.1                                                                                 *
+* Last updated: 17/10/2026                                                                     *
+* Author: Jim Gunther                                                                          *
+*                                                                                              *
+***********************************************************************************************/
+
+/*******************************************************************************************
+encode(): writes a report into buf in binary format version BIN_VERSION
+parameters:
+  rep: const report&: the interval's data
+  flags: uint8_t: which parts to include (BIN_STAR, BIN_FREQ, BIN_PEAK, BIN_STATS, BIN_WIND, BIN_PROF)
+  buf: uint8_t*: output buffer (BIN_LEN is always enough)
+  len: int: size of buf
+returns: int: bytes written, or -1 if buf was too small
+********************************************************************************************/
+int Telemetry::encode(const report& rep, uint8_t flags, uint8_t* buf, int len) {
+  int pos = 0, i;
+  uint32_t mask = 0;
+  if (len < 2) return -1;
+  buf[pos++] = BIN_VERSION;
+  buf[pos++] = flags;
+  bool ok = putU(rep.seq, buf, len, pos) && putU((uint32_t)rep.millis, buf, len, pos);
+  if (ok && (flags & BIN_FREQ)) {
+    ok = putU(rep.present, buf, len, pos);
+    for (i = 0; ok && (i < NUM_ITEMS); i++) {
+      if (rep.present & (1 << i)) ok = putS((int32_t)lroundf(rep.val[i] * itemScales[i]), buf, len, pos);
+    }
+  }
+  if (ok && (flags & BIN_PEAK)) ok = putS((int32_t)lroundf(rep.peak * 100.0f), buf, len, pos);
+  if (ok && (flags & BIN_STAR)) {
+    for (i = 0; i < NUM_SHIFT7; i++) {
+      if (rep.wd7[i] != 0) mask |= (1UL << i);
+    }
+    ok = putU(mask, buf, len, pos);
+    for (i = 0; ok && (i < NUM_SHIFT7); i++) {
+      if (rep.wd7[i] != 0) ok = putS(rep.wd7[i], buf, len, pos);
+    }
+  }
+  if (ok && (flags & BIN_STATS)) {
+    mask = 0;
+    for (i = 0; i < NUM_ITEMS; i++) {
+      if (rep.st[i].n > 0) mask |= (1UL << i);
+    }
+    ok = putU(mask, buf, len, pos);
+    for (i = 0; ok && (i < NUM_ITEMS); i++) {
+      if (rep.st[i].n == 0) continue;
+      int32_t lo = (int32_t)lroundf(rep.st[i].min * itemScales[i]);
+      ok = putU(rep.st[i].n, buf, len, pos) && putS(lo, buf, len, pos) &&
+           putS((int32_t)lroundf(rep.st[i].max * itemScales[i]) - lo, buf, len, pos) &&
+           putS((int32_t)lroundf(rep.st[i].sd * itemScales[i]), buf, len, pos);
+    }
+  }
+  if (ok && (flags & BIN_WIND)) {
+    ok = putU((uint32_t)lroundf(rep.wd.mean * 10.0f), buf, len, pos) &&
+         putU((uint32_t)lroundf(rep.wd.steady * 1000.0f), buf, len, pos) && putU(rep.wd.modal, buf, len, pos);
+  }
+  if (ok && (flags & BIN_PROF)) ok = putU(rep.profile, buf, len, pos) && putU(rep.secs, buf, len, pos);
+  return ok ? pos : -1;
+}
+
+/*******************************************************************************************
+decode(): reads a binary report back (used by the host decoder; not needed on the ESP32)
+parameters:
+  buf: const uint8_t*: encoded report, len: int: its length
+  rep: report&: receives the values (absent parts are zeroed)
+  flags: uint8_t*: receives the flags byte (may be NULL)
+returns: int: bytes consumed, or -1 if malformed or an unknown version
+********************************************************************************************/
+int Telemetry::decode(const uint8_t* buf, int len, report& rep, uint8_t* flags) {
+  int pos = 0, i;
+  uint32_t u, mask;
+  int32_t s;
+  memset(&rep, 0, sizeof(rep));
+  if ((len < 2) || (buf[0] != BIN_VERSION)) return -1;
+  pos = 1;
+  uint8_t f = buf[pos++];
+  if (flags) *flags = f;
+  if (!getU(buf, len, pos, rep.seq) || !getU(buf, len, pos, u)) return -1;
+  rep.millis = u;
+  if (f & BIN_FREQ) {
+    if (!getU(buf, len, pos, mask) || (mask & ~(uint32_t)ITEMS_ALL)) return -1;  // items this build lacks
+    rep.present = (uint16_t)(mask & ITEMS_ALL);
+    for (i = 0; i < NUM_ITEMS; i++) {
+      if ((mask & (1UL << i)) == 0) continue;
+      if (!getS(buf, len, pos, s)) return -1;
+      rep.val[i] = (float)s / itemScales[i];
+    }
+  }
+  if (f & BIN_PEAK) {
+    if (!getS(buf, len, pos, s)) return -1;
+    rep.peak = s * 0.01f;
+  }
+  if (f & BIN_STAR) {
+    if (!getU(buf, len, pos, mask)) return -1;
+    for (i = 0; i < NUM_SHIFT7; i++) {
+      if ((mask & (1UL << i)) == 0) continue;
+      if (!getS(buf, len, pos, s)) return -1;
+      rep.wd7[i] = s;
+    }
+  }
+  if (f & BIN_STATS) {
+    if (!getU(buf, len, pos, mask)) return -1;
+    for (i = 0; i < NUM_ITEMS; i++) {
+      if ((mask & (1UL << i)) == 0) continue;
+      int32_t lo, span;
+      if (!getU(buf, len, pos, u) || !getS(buf, len, pos, lo) || !getS(buf, len, pos, span) || !getS(buf, len, pos, s)) return -1;
+      rep.st[i].n = (uint16_t)u;
+      rep.st[i].min = (float)lo / itemScales[i];
+      rep.st[i].max = (float)(lo + span) / itemScales[i];
+      rep.st[i].sd = (float)s / itemScales[i];
+    }
+  }
+  if (f & BIN_WIND) {
+    uint32_t steady, modal;
+    if (!getU(buf, len, pos, u) || !getU(buf, len, pos, steady) || !getU(buf, len, pos, modal)) return -1;
+    rep.wd.mean = u * 0.1f;
+    rep.wd.steady = steady * 0.001f;
+    rep.wd.modal = (int)modal;
+  }
+  if (f & BIN_PROF) {
+    uint32_t secs;
+    if (!getU(buf, len, pos, u) || !getU(buf, len, pos, secs)) return -1;
+    rep.profile = (uint8_t)u;
+    rep.secs = (uint16_t)secs;
+  }
+  return pos;
+}
+
+bool Telemetry::putU(uint32_t v, uint8_t* buf, int len, int& pos) {
+  do {
+    if (pos >= len) return false;
+    uint8_t b = v & 0x7F;
+    v >>= 7;
+    buf[pos++] = v ? (b | 0x80) : b;
+  } while (v);
+  return true;
+}
+
+bool Telemetry::putS(int32_t v, uint8_t* buf, int len, int& pos) {
+  return putU(((uint32_t)v << 1) ^ (uint32_t)(v >> 31), buf, len, pos);  // zigzag: small magnitudes stay short
+}
+
+bool Telemetry::getU(const uint8_t* buf, int len, int& pos, uint32_t& v) {
+  int shift = 0;
+  v = 0;
+  while (pos < len) {
+    uint8_t b = buf[pos++];
+    if (shift > 28) return false;
+    v |= (uint32_t)(b & 0x7F) << shift;
+    if ((b & 0x80) == 0) return true;
+    shift += 7;
+  }
+  return false;
+}
+
+bool Telemetry::getS(const uint8_t* buf, int len, int& pos, int32_t& v) {
+  uint32_t u;
+  if (!getU(buf, len, pos, u)) return false;
+  v = (int32_t)(u >> 1) ^ -(int32_t)(u & 1);
+  return true;
+}
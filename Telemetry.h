@@ -0,0 +1,46 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+#include <stdint.h>
+#include "Config.h"
+#include "WInputs.h"
+
+/***********************************************************************************************
+* Telemetry.h: header file for Telemetry class: compact binary encoding of a report            *
+*                                                                                              *
+* Version: 0.1                                                                                 *
+* Last updated: 17/10/2026                                                                     *
+* Author: Jim Gunther                                                                          *
+*                                                                                              *
+* Layout (version 2), all integers LEB128 varints, signed ones zigzag-encoded first:           *
+*   version byte, flags byte (BIN_STAR, BIN_FREQ, BIN_PEAK, BIN_STATS, BIN_WIND, BIN_PROF)     *
+*   seq, interval end (millis)                                                                 *
+*   BIN_FREQ: item presence mask (report.present), then round(val * itemScales[i]) for each    *
+*             item present (scales from METEO_ITEMS)                                           *
+*   BIN_PEAK: round(peak * 100)                                                                *
+*   BIN_STAR: 32-bit mask of non-zero WD bins, then the count for each of those bins           *
+*   BIN_STATS: mask of sampled items, then for each: n, min, max - min, sd (scaled as values)  *
+*   BIN_WIND: round(mean WD * 10), round(steadiness * 1000), modal bin                         *
+*   BIN_PROF: profile (PROF_CALM, PROF_NORMAL, PROF_STORM), interval length (secs)             *
+***********************************************************************************************/
+
+#define BIN_STAR 1
+#define BIN_FREQ 2
+#define BIN_PEAK 4
+#define BIN_STATS 8
+#define BIN_WIND 16
+#define BIN_PROF 32
+// Everything a posted report carries (the star only while STAR_PAYLOAD is set)
+#define BIN_REPORT (BIN_FREQ | BIN_PEAK | BIN_STATS | BIN_WIND | BIN_PROF | (STAR_PAYLOAD ? BIN_STAR : 0))
+
+class Telemetry {
+  public:
+    static int encode(const report& rep, uint8_t flags, uint8_t* buf, int len);
+    static int decode(const uint8_t* buf, int len, report& rep, uint8_t* flags);
+    static bool putU(uint32_t v, uint8_t* buf, int len, int& pos);
+    static bool getU(const uint8_t* buf, int len, int& pos, uint32_t& v);
+
+  private:
+    static bool putS(int32_t v, uint8_t* buf, int len, int& pos);
+    static bool getS(const uint8_t* buf, int len, int& pos, int32_t& v);
+};
+#endif
@@ -1,5 +1,5 @@
 #include "WInputs.h"
-#include "config.h"
+#include "Config.h"
 #include <string.h>
 #include "Arduino.h"
 
@@ -11,39 +11,6 @@
 * Author: Jim Gunther                                                                          *
 *                                                                                              *
 ***********************************************************************************************/
-// Interrupt Service Routine starts here______________
-
-// Rain
-
-volatile unsigned long _lastRTime  = 0;
-volatile int _tipsCount; // number of rain bucket tips (cumulative per hour)
-const int _margin = 5;  // minimum milliseconds between checks: insurance against contact bounce: ?? STILL NEEDED FOR HALL EFFECT SENSORS???  
-const int _marginBuckets = 5;  // 5 milliseconds 
-
-void IRAM_ATTR buckets_tipped();
-void buckets_tipped() {
-unsigned long thisRTime = esp_timer_get_time() / 1000;
-  if (thisRTime - _lastRTime > _marginBuckets) {
-    _tipsCount++;
-    _lastRTime = thisRTime;
-  }
-}
-
-// Wind 
-volatile int _currRevs = 0;
-volatile unsigned long _lastSTime = 0;
-volatile unsigned long _thisSTime;
-
-void IRAM_ATTR one_Rotation();
-void one_Rotation() {
-  _thisSTime = esp_timer_get_time() / 1000;
-  if (_thisSTime - _lastSTime > _margin) {
-    _currRevs++;
-    _lastSTime = _thisSTime;
-  }
-}
-// ------------------------ END OF ISRs --------------------------------------------------------------
-
 // ************************* START OF Class WInputs PROPER *******************************************
 
 WInputs::WInputs() {};
@@ -55,80 +22,64 @@ void WInputs::begin() {
   pinMode(WDPin, INPUT_PULLUP);
   pinMode(VoltsPin, INPUT);
 
-  attachInterrupt(digitalPinToInterrupt(RainPin), buckets_tipped, CHANGE); // rain buckets
-  attachInterrupt(digitalPinToInterrupt(RevsPin), one_Rotation, RISING);  // anemometer
+  if (!_counter.begin()) Serial.println("Pulse counters failed: no wind or rain");
+  if (!_adc.begin()) Serial.println("Continuous ADC failed: vane and volts read one at a time");
 
-  _tipsCount = 0;
-  _prevTip = digitalRead(RainPin);
-  _currRevs = 0;
   _prevWDRevs = 0;
   _sensorStatus = 0;
-  //_prevA7 = analogRead(WDPin) >> 7;
-  char ixr[NUM_ITEMS << 1 + 1];
-  strcpy(ixr, INDEXER);
-  int i2;
+  _seq = 0;
+  _profRevs = _profTips = 0;
+  _intervalStart = millis();
+  _enabled = ITEMS_ALL;
   for (int i = 0; i < NUM_ITEMS; i++) {
-    i2 = i << 1;
-    _items[i].index = i;
-    _items[i].name[0] = ixr[i2];
-    _items[i].name[1] = ixr[i2 + 1];
-    _items[i].name[2] = '\0';
+    _latest[i] = 0.0f;
+    _period[i] = itemPeriods[i];
+    _lastSample[i] = 0;
+    _sentAt[i] = 0;
   }
   
   // Initialize the four I2C sensors
-  if (!_bmp.begin()) _sensorStatus = 1;
-  if (!_aht.begin()) _sensorStatus |= 2;
-  if (!_bh1750a.begin()) _sensorStatus |= 4;
-  if (!_bh1750b.begin(BH1750::CONTINUOUS_HIGH_RES_MODE, 0x5c)) _sensorStatus |=8;
+  _sensorStatus = _i2c.begin();
   Serial.print("Sensors: ");
   Serial.println(_sensorStatus);  
 }; 
 
 /**************************************************************************************************
-updateMaxGust(): results stored in one of 12 array posistions (12 == 3 secs speed measurement interval / 0.25 secs poll interval)
-(polled 4 times a second to catch gusts)
+updateMaxGust(): polls the pulse counter, which passes the revs to the gust meter (3-sec running
+mean gust and peak single-revolution speed) and the tips to the rain meter (rain rate, and its peak
+kept up to date here). Polled every loop: with COUNT_ISR only to keep the queues short, with
+COUNT_PCNT this is when the revs and tips are counted.
 parameters: none
 returns: void
 ***************************************************************************************************/
 void WInputs::updateMaxGust() { 
-  int n = 2; // index for gust
-  int revsNow = _currRevs; // from last interrupt
-  int revsInc = revsNow - _pollRevs[_ixPoll];
-  revsInc = max(0, revsInc);
-  _pollRevs[_ixPoll] = revsNow;
-
-  if (revsInc > _items[n].val) {
-    _items[n].val = (float)revsInc;
-  }
-
-  _ixPoll = (_ixPoll + 1) % POLL_COUNT;
+  _counter.poll((uint32_t)esp_timer_get_time(), _gusts, _rain);
+  _rain.update(millis());
 }
 
 /**************************************************************************************************
-checkTips(): checks if buckets have tipped and, if so, increments counter
-parameters:none
+WDChanged(): code to add anemometer revs to the WD star and vector mean (polled every second, and
+at the end of the interval): the revs since the last call go to the vane's mean over the same time
+parameters: none
 returns: void
 ***************************************************************************************************/
-void WInputs::checkTips() {
-  int currTip = digitalRead(RainPin);
-  if (currTip != _prevTip) _tipsCount++;
-  _prevTip = currTip;
+void WInputs::WDChanged() 
+{
+  int revsNow = _counter.revs();
+  _wind.add(_adc.takeVane(), revsNow - _prevWDRevs);
+  _prevWDRevs = revsNow;
 }
 
-/**************************************************************************************************
-WDChanged(): code to add anemometer revs to "frequent" and hourly revs count (polled every second)
+/****************************************************************************************************
+modalWD(): direction of the WD bin with the most revs so far this interval
 parameters: none
-returns: void
-***************************************************************************************************/
-void WInputs::WDChanged(bool endLoop) 
-{
-  int currA7 = analogRead(WDPin) >> 7;
-  int revsNow = _currRevs; // _currRevs is volatile
-  if ((currA7 != _prevA7) || endLoop) {
-    _wd7[_prevA7] += revsNow - _prevWDRevs;
-    _prevWDRevs = revsNow;
-    _prevA7 = currA7;
-  }
+return: float: degrees from north (WD_OFFSET applied), or -1 if calm
+****************************************************************************************************/
+float WInputs::modalWD() {
+  int bin = _wind.modal();
+  if (bin == CALM) return -1.0f;
+  float deg = (bin + 0.5f) * (360.0f / NUM_SHIFT7) + WD_OFFSET;
+  return (deg >= 360.0f) ? deg - 360.0f : deg;
 }
 
 /****************************************************************************************************
@@ -137,82 +88,131 @@ parameters: none
 return: int : light level (average of 2 sensors)
 ****************************************************************************************************/
 float WInputs::getLight4Blink() {
-  return (0.5f * (_items[7].val + _items[8].val));
+  return (0.5f * (_latest[IT_L1] + _latest[IT_L2]));
 }
 
 /***************************************************************************************************
-updateMeteo(): updates one of the Meteo values according to loopCount
-parameters: loopCount: int: the loop count number used to choose which Meteo object to update
-return: None
+pollSensors(): moves the I2C sensors' conversions on and collects the vane and volts ADC frame: called
+every loop; only waits on the bus to start a device again
+parameters: none
+return: void
 ****************************************************************************************************/
-int WInputs::updateMeteo(int loopCount, int maxLoop) {
-  int startLoop = maxLoop - 2 * NUM_ITEMS;
-  sensors_event_t humidity, temp;
-  float tmp;
-  float op;
-  float p = 0.0f;
-  int flag = 0;
-  if (loopCount < startLoop) return 0;
-  if (loopCount & 1) return 0;  // no odd-numbered loops
-
-  int ix = (loopCount - startLoop) >> 1;  // divide "excess" by 2 to choose the right Meteo object
-  
-  switch (ix) {
-    case 0: // rainfall/ bucket tips
-      _items[ix].val = (float)_tipsCount;
-      //flag = 1;
-      break;
-    case 1: // wind /revs
-      _items[ix].val = (float)_currRevs;
-      //flag = 2;
-      break;
-    case 2: // gusts
-      break; // nothing to do as gusts are updated more frequently
-    case 3:
-      _items[ix].val = analogRead(WDPin); // RPi calculated modal WD from Star data: this for "raw" data only
-      break;
-    case 4:
-      _hum = 98.0f;
-      tmp = 99.0f;
-      if (((_sensorStatus & 2) == 0) && _aht.getEvent(&humidity, &temp)) {
-        _hum = humidity.relative_humidity;
-        tmp = temp.temperature;
-      }
-      _items[ix].val = tmp;
-      //flag = 4;
-      break;
-    case 5: // humidity should be stored 0.5 secs ago by line 190
-      _items[ix].val = _hum;
-      //flag = 8;
-      break;
-    case 6: // pressure:
-      p = 97.0f;
-      if ((_sensorStatus & 1) == 0) _bmp.getPressure(&p);
-      _items[ix].val = 0.01f * p;
-      //flag = 16;
-      break;      
-    case 7: // light 1 :: 11 * log10(1 + lux)
-      op = 96.0f;
-      if ((_sensorStatus & 4) == 0) op = _bh1750a.readLightLevel();
-      if (op < 0.0) op = 0.0;
-      _items[ix].val = op;
-      //flag = 32;
-      break;
-    case 8: // light 2
-      op = 95.0f;
-      if ((_sensorStatus & 8) == 0) op = _bh1750b.readLightLevel();
-      if (op < 0.0) op = 0.0;
-      _items[ix].val = op;
-      //flag = 64;
-      break;
-    case 9:
-      _items[ix].val = (float)analogRead(VoltsPin);
-      //flag = 128;
-      break;
-    default:
-      break;
-  }
-  return flag;
+void WInputs::pollSensors() {
+  _i2c.tick(millis());
+  _adc.poll();
+}
+
+/***************************************************************************************************
+updateMeteo(): samples each enabled meteo item whose period (METEO_ITEMS or TOPIC_CONFIG, stretched in the
+               calm profile) is up, adding the reading to the interval's running statistics. The item list
+               unrolls here at compile time: items with period 0 (read at the interval end) drop out altogether.
+parameters: none
+return: void
+****************************************************************************************************/
+void WInputs::updateMeteo() {
+  unsigned long now = millis();
+  unsigned long scale = _rate.periodScale();
+  float val;
+#define ITEM_SAMPLE(id, name, reader, period, sc, noData, deadband, silence)                             \
+  if (((period) > 0) && (_enabled & (1 << IT_##id)) && (now - _lastSample[IT_##id] >= _period[IT_##id] * scale) && \
+      reader(now, val))                                                                                            \
+    took(IT_##id, now, val);
+  METEO_ITEMS(ITEM_SAMPLE)
+#undef ITEM_SAMPLE
+}
+
+/***************************************************************************************************
+updateProfile(): passes the last second's revs and tips to the rate controller (call once a second,
+                 before resetAll() at an interval end); a new profile's sampling periods apply at once
+parameters: none
+return: bool: true if the profile changed (the caller then resizes the report interval)
+****************************************************************************************************/
+bool WInputs::updateProfile() {
+  int revs = _counter.revs();
+  int tips = _counter.tips();
+  bool changed = _rate.addSecond(revs - _profRevs, tips - _profTips);
+  _profRevs = revs;
+  _profTips = tips;
+  if (changed) _i2c.setPeriod(SENSOR_PERIOD * _rate.periodScale());
+  return changed;
+}
+
+void WInputs::took(int ix, unsigned long now, float val) {
+  _lastSample[ix] = now;
+  _latest[ix] = val;
+  _stats[ix].add(val);
+}
+
+/***************************************************************************************************
+Item readers (see METEO_ITEMS): counters as they stand, the gust and rain meters, the ADCs, and the I2C
+values pollSensors() last collected (false if that sensor has no recent reading)
+parameters: now: unsigned long: millis(), val: float&: the reading
+return: bool: true if val was set
+****************************************************************************************************/
+bool WInputs::readTips(unsigned long now, float& val) {
+  val = (float)_counter.tips();
+  return true;
+}
+
+bool WInputs::readRevs(unsigned long now, float& val) {
+  val = (float)_counter.revs();
+  return true;
+}
+
+bool WInputs::readGust(unsigned long now, float& val) {
+  val = _gusts.getGust();
+  return true;
+}
+
+bool WInputs::readRainRate(unsigned long now, float& val) {
+  val = _rain.rate(now, RAIN_RATE_WINDOW);
+  return true;
+}
+
+bool WInputs::readRainPeak(unsigned long now, float& val) {
+  _rain.update(now);
+  val = _rain.getPeak();
+  return true;
+}
+
+bool WInputs::readVane(unsigned long now, float& val) {
+  val = _adc.vane();  // RPi calculates modal WD from Star data: this for "raw" data only
+  return true;
+}
+
+bool WInputs::readTemp(unsigned long now, float& val) {
+  if (!_i2c.isFresh(DEV_AHT, now)) return false;
+  val = _i2c.temperature();
+  return true;
+}
+
+bool WInputs::readHum(unsigned long now, float& val) {
+  if (!_i2c.isFresh(DEV_AHT, now)) return false;
+  val = _i2c.humidity();
+  return true;
+}
+
+bool WInputs::readPres(unsigned long now, float& val) {
+  if (!_i2c.isFresh(DEV_BMP, now)) return false;
+  val = 0.01f * _i2c.pressure();  // hPa
+  return true;
+}
+
+bool WInputs::readLightA(unsigned long now, float& val) {
+  if (!_i2c.isFresh(DEV_BHA, now)) return false;
+  val = _i2c.lightA();
+  return true;
+}
+
+bool WInputs::readLightB(unsigned long now, float& val) {
+  if (!_i2c.isFresh(DEV_BHB, now)) return false;
+  val = _i2c.lightB();
+  return true;
+}
+
+bool WInputs::readVolts(unsigned long now, float& val) {
+  val = _adc.takeVolts();  // the mean since the last sample
+  return true;
 }
 
 /********************************************************************************************
@@ -222,51 +222,183 @@ returns: void
 ********************************************************************************************/
 void WInputs::resetAll() {
   int i;
-  for (i = 0; i < NUM_SHIFT7; i++) _wd7[i] = 0;
-  _currRevs = 0;
+  _wind.reset();
+  _counter.reset();
   _prevWDRevs = 0;
-  _tipsCount = 0;
-  _items[2].val = 0;  // reset max gust
+  _profRevs = _profTips = 0;
+  _intervalStart = millis();
+  _gusts.reset();
+  _rain.reset();
+  for (i = 0; i < NUM_ITEMS; i++) _stats[i].reset();
+}
+
+/*******************************************************************************************
+getReport(): copies this interval's values and WD star counts ready for posting: counters as
+             they stand now, sampled items as their interval means (noData if no samples)
+parameter: rep: report&: the report to fill in
+returns: void
+********************************************************************************************/
+void WInputs::getReport(report& rep) {
+  int i;
+  rep.seq = _seq++;
+  rep.millis = millis();
+#define ITEM_END(id, name, reader, period, scale, noData, deadband, silence) \
+  if ((period) == 0) reader(rep.millis, _latest[IT_##id]);
+  METEO_ITEMS(ITEM_END)
+#undef ITEM_END
+  for (i = 0; i < NUM_ITEMS; i++) {
+    rep.val[i] = _latest[i];
+    rep.st[i].n = _stats[i].count();
+    rep.st[i].min = _stats[i].min();
+    rep.st[i].max = _stats[i].max();
+    rep.st[i].sd = _stats[i].sd();
+    if (rep.st[i].n > 0) rep.val[i] = _stats[i].mean();
+    else if (itemPeriods[i] > 0) rep.val[i] = itemNoData[i];
+  }
+  for (i = 0; i < NUM_SHIFT7; i++) rep.wd7[i] = _wind.bins()[i];
+  _wind.summary(rep.wd);
+  rep.peak = _gusts.getPeak();
+  rep.profile = (uint8_t)_rate.profile();
+  rep.secs = (uint16_t)((rep.millis - _intervalStart + 500) / 1000);
+  rep.present = REPORT_BY_EXCEPTION ? exceptions(rep) : (ITEMS_ALL & _enabled);
+}
+
+/*******************************************************************************************
+getConfig(): the item settings now in force (the sampling task's; call before it starts)
+parameters: cfg: runConfig&: receives the periods, enabled items and profile pin
+returns: void
+********************************************************************************************/
+void WInputs::getConfig(runConfig& cfg) {
+  for (int i = 0; i < NUM_ITEMS; i++) cfg.period[i] = _period[i];
+  cfg.enabled = _enabled;
+  cfg.profile = _rate.pinned();
+}
+
+/*******************************************************************************************
+setConfig(): new item settings, from the next sample on (sampling task, at an interval boundary:
+             nothing counted so far is lost)
+parameters: cfg: const runConfig&: checked already (see parseConfig())
+returns: void
+********************************************************************************************/
+void WInputs::setConfig(const runConfig& cfg) {
+  for (int i = 0; i < NUM_ITEMS; i++) {
+    if (itemPeriods[i] > 0) _period[i] = cfg.period[i];
+  }
+  _enabled = cfg.enabled & ITEMS_ALL;
+  if (_rate.pin(cfg.profile)) _i2c.setPeriod(SENSOR_PERIOD * _rate.periodScale());
 }
 
 /*******************************************************************************************
-getFreqCSV(): code to concatenate all the weather values CSV strings and place in buffer (82+ bytes length)
-parameter: buf: char*: buffer to receive CSV text
-returns: int: revs count this reporting interval
+exceptions(): picks the enabled items worth sending: counts always, others when they have moved more
+              than their deadband since they last went out or have been silent for their silence (secs)
+parameter: rep: const report&: this interval's values
+returns: uint16_t: presence mask (bit per item)
 ********************************************************************************************/
-float WInputs::getFreqCSV(char* buf) {
+uint16_t WInputs::exceptions(const report& rep) {
+  uint16_t mask = 0;
+  for (int i = 0; i < NUM_ITEMS; i++) {
+    if (!(_enabled & (1 << i))) continue;  // switched off by TOPIC_CONFIG
+    if ((itemDeadband[i] >= 0.0f) && (_sentAt[i] != 0) && (fabsf(rep.val[i] - _lastSent[i]) <= itemDeadband[i]) &&
+        (rep.millis - _sentAt[i] < itemSilence[i] * 1000UL)) continue;
+    mask |= (1 << i);
+    _lastSent[i] = rep.val[i];
+    _sentAt[i] = (rep.millis != 0) ? rep.millis : 1;
+  }
+  return mask;
+}
+
+/*******************************************************************************************
+getFreqCSV(): code to concatenate all the weather values CSV strings and place in buffer (FREQBUF_LEN);
+              items left out by report by exception are empty fields, so the rest keep their places.
+              The first CSV_ITEMS items only.
+parameters:
+  rep: const report&: the interval's values
+  buf: char*: buffer to receive CSV text
+returns: float: revs count this reporting interval
+********************************************************************************************/
+float WInputs::getFreqCSV(const report& rep, char* buf) {
   char mBuf[FITEM_LEN + 4];
   int i;
   int len = 0;
-  for (i = 0; i < NUM_ITEMS; i++) {
-    sprintf(mBuf, ",%07.2f", _items[i].val);
+  for (i = 0; i < CSV_ITEMS; i++) {
+    if (rep.present & (1 << i)) sprintf(mBuf, ",%07.2f", rep.val[i]);
+    else strcpy(mBuf, ",");
     strcpy(buf + len, mBuf);
     len = strlen(mBuf) + len;
   }
-  return _items[1].val;
+  return rep.val[IT_WS];
 }
 
 /*******************************************************************************************
 getStarCSV(): code to concatenate all the wind direction values CSV strings and place in buffer (82+ bytes length)
-parameter: buf: char*: buffer to receive CSV text
-returns: bool: True if success, otherwise false
+parameters:
+  rep: const report&: the interval's WD star counts
+  buf: char*: buffer to receive CSV text
+returns: int: sum of the star counts
 ********************************************************************************************/
-int WInputs::getStarCSV(char* buf) {
-  char mBuf[HITEM_LEN + 1];
+int WInputs::getStarCSV(const report& rep, char* buf) {
   int i, sum = 0;
-  for (i = 0; i < NUM_SHIFT7; i++) {
-    sprintf(mBuf, ",%02d", _wd7[i]);
-    strcpy(buf + i * HITEM_LEN, mBuf);
-    sum += _wd7[i];
+  int len = 0;
+  buf[0] = '\0';
+  for (i = 0; i < NUM_SHIFT7; i++) {  // counts of 100+ just widen their field (they used to overrun)
+    len += snprintf(buf + len, STARBUF_LEN - 1 - len, ",%02d", rep.wd7[i]);
+    if (len >= STARBUF_LEN - 1) len = STARBUF_LEN - 2;
+    sum += rep.wd7[i];
   }
   return sum;
 }
 
+/*******************************************************************************************
+getStatsCSV(): lists the spread of each sampled item's readings: ",<name>,<n>,<min>,<max>,<sd>"
+parameters:
+  rep: const report&: the interval's values
+  buf: char*: buffer to receive CSV text (STATSBUF_LEN)
+returns: int: number of items listed
+********************************************************************************************/
+int WInputs::getStatsCSV(const report& rep, char* buf) {
+  int i, items = 0;
+  int len = 0;
+  buf[0] = '\0';
+  for (i = 0; i < NUM_ITEMS; i++) {
+    if (rep.st[i].n == 0) continue;
+    len += snprintf(buf + len, STATSBUF_LEN - len, ",%s,%u,%.2f,%.2f,%.2f", itemNames[i], rep.st[i].n,
+                    rep.st[i].min, rep.st[i].max, rep.st[i].sd);
+    if (len >= STATSBUF_LEN) {
+      buf[len = STATSBUF_LEN - 1] = '\0';
+      break;
+    }
+    items++;
+  }
+  return items;
+}
+
+/*******************************************************************************************
+getWindCSV(): the interval's WD summary: ",<mean degrees>,<steadiness>,<modal bin>"
+parameters:
+  rep: const report&: the interval's values
+  buf: char*: buffer to receive CSV text (ICSV_LEN * 3 is enough)
+returns: void
+********************************************************************************************/
+void WInputs::getWindCSV(const report& rep, char* buf) {
+  sprintf(buf, ",%05.1f,%.2f,%02d", rep.wd.mean, rep.wd.steady, rep.wd.modal);
+}
+
+/*******************************************************************************************
+getTagCSV(): the profile the interval ended in and its length: ",<C|N|S>,<secs>"
+parameters:
+  rep: const report&: the interval's values
+  buf: char*: buffer to receive CSV text (ICSV_LEN is enough)
+returns: void
+********************************************************************************************/
+void WInputs::getTagCSV(const report& rep, char* buf) {
+  sprintf(buf, ",%c,%u", PROF_TAGS[rep.profile % NUM_PROFILES], (unsigned)rep.secs);
+}
+
 /*******************************************************************************************
 getA7(): code to get WD analogue value / 128
 parameter: none
 returns: int: analogue value >> 7
 *****************************************************************************************/
 int WInputs::getA7() {
-  return (analogRead(WDPin) >> 7);
+  return ((int)_adc.vane() >> 7);
 }
\ No newline at end of file
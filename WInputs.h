@@ -1,11 +1,14 @@
 #ifndef W_INPUTS
 #define W_INPUTS
-#include "config.h"
-
-#include <Wire.h>
-#include <Adafruit_BMP085_U.h>
-#include <Adafruit_AHTX0.h>
-#include <BH1750.h>
+#include "Config.h"
+#include "I2CSensors.h"
+#include "GustMeter.h"
+#include "RainMeter.h"
+#include "AdcSampler.h"
+#include "PulseCounter.h"
+#include "RunStats.h"
+#include "WindDir.h"
+#include "RateControl.h"
 
 /***********************************************************************************************
 * WInputs.h: header file for WIinputs class (replaces both RainWind ans Sesnsors classes)      *
@@ -15,10 +18,50 @@
 * Author: Jim Gunther                                                                          *
 *                                                                                              *
 ***********************************************************************************************/
-struct meteo {
-  int index;
-  float val;
-  char name[INAME_LEN];
+// Item tables, made at compile time from METEO_ITEMS (Config.h)
+#define ITEM_NAME(id, name, reader, period, scale, noData, deadband, silence) name,
+#define ITEM_PERIOD(id, name, reader, period, scale, noData, deadband, silence) period,
+#define ITEM_SCALE(id, name, reader, period, scale, noData, deadband, silence) scale,
+#define ITEM_NODATA(id, name, reader, period, scale, noData, deadband, silence) noData,
+#define ITEM_DEADBAND(id, name, reader, period, scale, noData, deadband, silence) deadband,
+#define ITEM_SILENCE(id, name, reader, period, scale, noData, deadband, silence) silence,
+static constexpr const char* itemNames[NUM_ITEMS] = { METEO_ITEMS(ITEM_NAME) };
+static constexpr unsigned long itemPeriods[NUM_ITEMS] = { METEO_ITEMS(ITEM_PERIOD) };
+static constexpr int32_t itemScales[NUM_ITEMS] = { METEO_ITEMS(ITEM_SCALE) };
+static constexpr float itemNoData[NUM_ITEMS] = { METEO_ITEMS(ITEM_NODATA) };
+static constexpr float itemDeadband[NUM_ITEMS] = { METEO_ITEMS(ITEM_DEADBAND) };
+static constexpr unsigned long itemSilence[NUM_ITEMS] = { METEO_ITEMS(ITEM_SILENCE) };
+
+// Spread of one sampled item's readings over an interval (its mean is the reported value)
+struct itemStat {
+  uint16_t n;  // samples taken: 0 for items read at the interval end (period 0)
+  float min;
+  float max;
+  float sd;
+};
+
+// One report interval's results, handed from the sampling task to the network task
+struct report {
+  uint32_t seq;
+  unsigned long millis;  // when the interval ended
+  float val[NUM_ITEMS];
+  int wd7[NUM_SHIFT7];
+  float peak;  // fastest single revolution (revs per 3 secs)
+  itemStat st[NUM_ITEMS];
+  wdSummary wd;
+  uint8_t profile;  // PROF_CALM, PROF_NORMAL or PROF_STORM at the interval's end
+  uint16_t secs;    // interval length: it varies with the profile
+  uint16_t present; // items carried (bit per item): with REPORT_BY_EXCEPTION the rest are unchanged
+};
+
+// Settings TOPIC_CONFIG can change: taken by the sampling task at an interval boundary, then echoed
+struct runConfig {
+  int id;           // the sender's number for this change, echoed back (0: none given)
+  int rptIntvl;     // the Shed's report interval (loops), before the profile scales it
+  int blink;        // loops between LED blinks (ZONE12)
+  int profile;      // PROF_ profile pinned, or PROF_AUTO
+  uint16_t enabled; // items reported (bit per item)
+  unsigned long period[NUM_ITEMS];  // ms between samples of each sampled item (0: read at the interval end)
 };
 
 class WInputs {
@@ -26,34 +69,66 @@ class WInputs {
     WInputs();
     void begin();
     void updateMaxGust();
-    void WDChanged(bool endLoop);
-    void checkTips();
+    void WDChanged();
     float modalWD();
     float getLight4Blink();
-    int updateMeteo(int loopCount, int maxLoop);
+    void updateMeteo();
+    bool updateProfile();
+    int profileLoops(int baseLoops) { return _rate.intervalLoops(baseLoops); }
+    void pollSensors();
+    bool sensorNews(char* buf, int len) { return _i2c.getNews(buf, len); }
     void resetAll();
-    float getFreqCSV(char* buf);
-    int getStarCSV(char *buf);
+    void getReport(report& rep);
+    void setSeq(uint32_t seq) { _seq = seq; }
+    void getConfig(runConfig& cfg);
+    void setConfig(const runConfig& cfg);
+    static float getFreqCSV(const report& rep, char* buf);
+    static int getStarCSV(const report& rep, char *buf);
+    static int getStatsCSV(const report& rep, char* buf);
+    static void getWindCSV(const report& rep, char* buf);
+    static void getTagCSV(const report& rep, char* buf);
     int getA7();
 
   private:
+    void took(int ix, unsigned long now, float val);
+    // Item readers (see METEO_ITEMS): false if there is no recent reading
+    bool readTips(unsigned long now, float& val);
+    bool readRevs(unsigned long now, float& val);
+    bool readGust(unsigned long now, float& val);
+    bool readRainRate(unsigned long now, float& val);
+    bool readRainPeak(unsigned long now, float& val);
+    bool readVane(unsigned long now, float& val);
+    bool readTemp(unsigned long now, float& val);
+    bool readHum(unsigned long now, float& val);
+    bool readPres(unsigned long now, float& val);
+    bool readLightA(unsigned long now, float& val);
+    bool readLightB(unsigned long now, float& val);
+    bool readVolts(unsigned long now, float& val);
+    uint16_t exceptions(const report& rep);
+
     // Nested classes
-    Adafruit_AHTX0 _aht;
-    Adafruit_BMP085_Unified _bmp;
-    BH1750 _bh1750a;
-    BH1750 _bh1750b;  
-    
-    int _ixPoll;
+    I2CSensors _i2c;
+    GustMeter _gusts;
+    RainMeter _rain;
+    PulseCounter _counter;
+    AdcSampler _adc;
+    WindDir _wind;
+    RateControl _rate;
+
+    uint32_t _seq;
     uint _sensorStatus;
-    float _hum; // temporary store for humidity between loops
-    int _prevTip;
-    int _tipsCount;
     int _prevWD;
     int _prevWDRevs;
-    int _prevA7;
-    int _pollRevs[POLL_COUNT];
-    int _wd7[NUM_SHIFT7];
-    meteo _items[NUM_ITEMS];
+    float _latest[NUM_ITEMS];  // latest reading of each item
+    unsigned long _period[NUM_ITEMS];  // sampling periods: METEO_ITEMS, or as TOPIC_CONFIG set them
+    uint16_t _enabled;                 // items reported (bit per item)
+    RunStats _stats[NUM_ITEMS];
+    unsigned long _lastSample[NUM_ITEMS];
+    int _profRevs;  // counts at the last updateProfile()
+    int _profTips;
+    unsigned long _intervalStart;
+    float _lastSent[NUM_ITEMS];         // value each item last went out with ...
+    unsigned long _sentAt[NUM_ITEMS];   // ... and when (millis(); 0: never)
   
 };
 #endif
\ No newline at end of file
@@ -0,0 +1,110 @@
+#include "WindDir.h"
+#include <math.h>
+
+/***********************************************************************************************
+* WindDir.cpp: WindDir class: each WDChanged() sample adds its revs to its bin's count and     *
+*              its own unit vector times revs (table look-ups only); atan2f and sqrtf are      *
+*              used once per interval, in summary()                                            *
+*                                                                                              *
+* Version: 0.1                                                                                 *
+* Last updated: 17/10/2026                                                                     *
+* Author: Jim Gunther                                                                          *
+*                                                                                              *
+* The star's bin i is vane counts >> 7, 11.25 degrees wide. The mean is worked out from the    *
+* averaged vane readings themselves, so it is not limited to the bins' resolution. The unit    *
+* vectors come from a quarter-wave table in 1.4 degree steps, interpolated (error < 0.0001).   *
+***********************************************************************************************/
+
+#define SIN_STEPS 256  // table steps in a turn (a quarter is SIN_STEPS / 4)
+
+// sin(i * 2pi / SIN_STEPS) for the first quarter turn, both ends included
+static const float quarterSin[SIN_STEPS / 4 + 1] = {
+  0.0000000f, 0.0245412f, 0.0490677f, 0.0735646f, 0.0980171f, 0.1224107f, 0.1467305f, 0.1709619f,
+  0.1950903f, 0.2191012f, 0.2429802f, 0.2667128f, 0.2902847f, 0.3136817f, 0.3368899f, 0.3598950f,
+  0.3826834f, 0.4052413f, 0.4275551f, 0.4496113f, 0.4713967f, 0.4928982f, 0.5141027f, 0.5349976f,
+  0.5555702f, 0.5758082f, 0.5956993f, 0.6152316f, 0.6343933f, 0.6531728f, 0.6715590f, 0.6895405f,
+  0.7071068f, 0.7242471f, 0.7409511f, 0.7572088f, 0.7730105f, 0.7883464f, 0.8032075f, 0.8175848f,
+  0.8314696f, 0.8448536f, 0.8577286f, 0.8700870f, 0.8819213f, 0.8932243f, 0.9039893f, 0.9142098f,
+  0.9238795f, 0.9329928f, 0.9415441f, 0.9495282f, 0.9569403f, 0.9637761f, 0.9700313f, 0.9757021f,
+  0.9807853f, 0.9852776f, 0.9891765f, 0.9924795f, 0.9951847f, 0.9972905f, 0.9987955f, 0.9996988f,
+  1.0000000f
+};
+
+// sin(k * 2pi / SIN_STEPS), any k >= 0, from the quarter wave
+static float sinStep(int k) {
+  k %= SIN_STEPS;
+  int j = k % (SIN_STEPS / 4);
+  float v = ((k / (SIN_STEPS / 4)) & 1) ? quarterSin[SIN_STEPS / 4 - j] : quarterSin[j];
+  return (k >= SIN_STEPS / 2) ? -v : v;
+}
+
+WindDir::WindDir() {
+  reset();
+};
+
+/**************************************************************************************************
+add(): counts revs against a vane reading
+parameters: vane: float: averaged vane counts (0 to under ADC_COUNTS), revs: int: anemometer revs while
+            the vane was there
+returns: void
+***************************************************************************************************/
+void WindDir::add(float vane, int revs) {
+  if ((vane < 0.0f) || (vane >= ADC_COUNTS) || (revs <= 0)) return;
+  _bins[(int)vane >> 7] += revs;
+  float s, c;
+  unitVector(vane, s, c);
+  _sin += revs * s;
+  _cos += revs * c;
+  _revs += revs;
+}
+
+/**************************************************************************************************
+unitVector(): sine and cosine of a vane reading's angle, from the table (no libm)
+parameters: vane: float: counts (0 to under ADC_COUNTS), s: float&: receives the sine, c: float&: the cosine
+returns: void
+***************************************************************************************************/
+void WindDir::unitVector(float vane, float& s, float& c) {
+  float x = vane * (SIN_STEPS / ADC_COUNTS);
+  if (x < 0.0f) x = 0.0f;
+  int k = (int)x;
+  float f = x - k;
+  float s0 = sinStep(k), c0 = sinStep(k + SIN_STEPS / 4);
+  s = s0 + f * (sinStep(k + 1) - s0);
+  c = c0 + f * (sinStep(k + 1 + SIN_STEPS / 4) - c0);
+}
+
+void WindDir::reset() {
+  for (int i = 0; i < NUM_SHIFT7; i++) _bins[i] = 0;
+  _sin = _cos = 0.0f;
+  _revs = 0;
+}
+
+/**************************************************************************************************
+modal(): the bin with the most revs (lowest-numbered on a tie)
+parameters: none
+returns: int: 0-31, or CALM if no revs
+***************************************************************************************************/
+int WindDir::modal() {
+  int best = CALM;
+  for (int i = 0; i < NUM_SHIFT7; i++) {
+    if ((_bins[i] > 0) && ((best == CALM) || (_bins[i] > _bins[best]))) best = i;
+  }
+  return best;
+}
+
+/**************************************************************************************************
+summary(): mean direction, steadiness and modal bin for the interval so far
+parameters: out: wdSummary&: receives them (mean 0 and steadiness 0 when calm)
+returns: void
+***************************************************************************************************/
+void WindDir::summary(wdSummary& out) {
+  out.modal = modal();
+  out.mean = 0.0f;
+  out.steady = 0.0f;
+  if (_revs == 0) return;
+  out.steady = sqrtf(_sin * _sin + _cos * _cos) / _revs;
+  float deg = atan2f(_sin, _cos) * (180.0f / (float)M_PI) + WD_OFFSET;
+  while (deg < 0.0f) deg += 360.0f;
+  while (deg >= 360.0f) deg -= 360.0f;
+  out.mean = deg;
+}
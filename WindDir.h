@@ -0,0 +1,39 @@
+#ifndef WIND_DIR_H
+#define WIND_DIR_H
+#include <stdint.h>
+#include "Config.h"
+
+/***********************************************************************************************
+* WindDir.h: header file for WindDir class: WD star counts and revs-weighted vector mean of    *
+*            the wind direction over a report interval                                         *
+*                                                                                              *
+* Version: 0.1                                                                                 *
+* Last updated: 17/10/2026                                                                     *
+* Author: Jim Gunther                                                                          *
+*                                                                                              *
+***********************************************************************************************/
+
+// Summary of an interval's wind direction
+struct wdSummary {
+  float mean;   // degrees (0-360, WD_OFFSET applied) of the revs-weighted mean wind vector
+  float steady; // length of that vector per rev: 1 = dead steady, 0 = all over the place (or calm)
+  int modal;    // bin with the most revs (0-31), or CALM if there were none
+};
+
+class WindDir {
+  public:
+    WindDir();
+    void add(float vane, int revs);
+    static void unitVector(float vane, float& s, float& c);
+    void reset();
+    const int* bins() { return _bins; }
+    int modal();
+    void summary(wdSummary& out);
+
+  private:
+    int _bins[NUM_SHIFT7];  // revs counted in each WD bin (the "star")
+    float _sin;             // revs-weighted sum of each reading's sine ...
+    float _cos;             // ... and cosine
+    int _revs;
+};
+#endif
@@ -0,0 +1,105 @@
+#include "ZoneMetrics.h"
+#include "Arduino.h"
+#include <stdio.h>
+#include <string.h>
+
+/***********************************************************************************************
+* ZoneMetrics.cpp: ZoneMetrics class: ZONE_MARK() closes the zone open in the calling task's   *
+*                  slot (charging its time to that zone's histogram) and opens the next        *
+*                                                                                              *
+* Version: 0.1                                                                                 *
+* Last updated: 17/10/2026                                                                     *
+* Author: Jim Gunther                                                                          *
+*                                                                                              *
+* Each task passes its own ZS_ slot: the OTA task shares the network task's core, so the core  *
+* id cannot tell them apart. A slot, and each zone, is only ever written by the one task.      *
+***********************************************************************************************/
+
+static const char* metricNames[NUM_MT] = { "every", "wd", "blink", "report", "ota", "mqtt", "reconn", "publish",
+                                           "i2c", "loop", "pub" };
+
+ZoneMetrics zoneMetrics;
+
+void zoneMark(int slot, int zone) {
+  zoneMetrics.mark(slot, zone);
+}
+
+ZoneMetrics::ZoneMetrics() {
+  memset(_hist, 0, sizeof(_hist));
+  memset(_posted, 0, sizeof(_posted));
+  _epoch = 0;
+  for (int i = 0; i < NUM_ZS; i++) {
+    _zone[i] = ZT_IDLE;
+    _start[i] = 0;
+  }
+};
+
+/**************************************************************************************************
+mark(): closes the zone open in a task's slot and opens another
+parameters: slot: int: the calling task's ZS_ slot, zone: int: the zone now starting (ZT_IDLE when the task
+            goes idle)
+returns: void
+***************************************************************************************************/
+void ZoneMetrics::mark(int slot, int zone) {
+  if ((slot < 0) || (slot >= NUM_ZS)) return;
+  uint32_t now = (uint32_t)esp_timer_get_time();
+  if (_zone[slot] >= 0) add(_zone[slot], now - _start[slot]);
+  _zone[slot] = zone;
+  _start[slot] = now;
+}
+
+/**************************************************************************************************
+add(): counts one timing; only ever called from the task that owns the metric
+parameters: metric: int: ZT_ or MT_ id, us: uint32_t: time taken (usecs)
+returns: void
+***************************************************************************************************/
+void ZoneMetrics::add(int metric, uint32_t us) {
+  if ((metric < 0) || (metric >= NUM_MT)) return;
+  zoneHist& h = _hist[metric];
+  int b = (us == 0) ? 0 : 32 - __builtin_clz(us);
+  if (b >= METRIC_BUCKETS) b = METRIC_BUCKETS - 1;
+  h.bucket[b]++;
+  if ((h.maxEpoch != _epoch) || (us > h.maxUs)) {
+    h.maxUs = us;
+    h.maxEpoch = _epoch;
+  }
+}
+
+/**************************************************************************************************
+getCSV(): for each metric with timings since the last call: ",<name>,<n>,<p50>,<p99>,<max>" (usecs);
+          then starts a new period
+parameters: buf: char*: receives the CSV text, len: int: size of buf
+returns: int: number of metrics listed
+***************************************************************************************************/
+int ZoneMetrics::getCSV(char* buf, int len) {
+  uint32_t counts[METRIC_BUCKETS];
+  int i, b, pos = 0, listed = 0;
+  buf[0] = '\0';
+  for (i = 0; i < NUM_MT; i++) {
+    uint32_t n = 0, below = 0, p50 = 0, p99 = 0;
+    for (b = 0; b < METRIC_BUCKETS; b++) {
+      uint32_t c = _hist[i].bucket[b];
+      counts[b] = c - _posted[i][b];
+      _posted[i][b] = c;
+      n += counts[b];
+    }
+    if (n == 0) continue;
+    for (b = 0; b < METRIC_BUCKETS; b++) {
+      below += counts[b];
+      uint32_t top = (b == 0) ? 1 : (1UL << b);
+      if ((p50 == 0) && (below * 2 >= n)) p50 = top;
+      if ((p99 == 0) && (below * 100 >= n * 99)) p99 = top;
+    }
+    uint32_t maxUs = (_hist[i].maxEpoch == _epoch) ? _hist[i].maxUs : 0;
+    int w = snprintf(buf + pos, len - pos, ",%s,%u,%u,%u,%u", metricNames[i], (unsigned)n, (unsigned)p50,
+                     (unsigned)p99, (unsigned)maxUs);
+    if (pos + w >= len) {
+      buf[pos] = '\0';
+      break;
+    }
+    pos += w;
+    listed++;
+  }
+  _epoch++;
+  return listed;
+}
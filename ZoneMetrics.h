@@ -0,0 +1,46 @@
+#ifndef ZONE_METRICS_H
+#define ZONE_METRICS_H
+#include <stdint.h>
+#include "Config.h"
+
+/***********************************************************************************************
+* ZoneMetrics.h: header file for ZoneMetrics class: latency histograms for each timing zone,   *
+*                whole sampling passes and MQTT publishes                                      *
+*                                                                                              *
+* Version: 0.1                                                                                 *
+* Last updated: 17/10/2026                                                                     *
+* Author: Jim Gunther                                                                          *
+*                                                                                              *
+* Bucket b counts times of 2^(b-1) to 2^b - 1 usecs (bucket 0: under 1 usec), so p50 and p99   *
+* come out as the bucket's upper bound. Each metric has one writer (the task that times it);   *
+* the network task only reads, keeping its own copy of the counts at the last post.            *
+***********************************************************************************************/
+
+// Metric ids: the ZT_ zones, then these
+#define MT_LOOP NUM_ZT         // whole sampleTick() pass
+#define MT_PUB (NUM_ZT + 1)    // one qtClient.publish()
+#define NUM_MT (NUM_ZT + 2)
+
+struct zoneHist {
+  uint32_t bucket[METRIC_BUCKETS];
+  uint32_t maxUs;     // longest time since the last post ...
+  uint32_t maxEpoch;  // ... as long as this matches the current epoch
+};
+
+class ZoneMetrics {
+  public:
+    ZoneMetrics();
+    void mark(int slot, int zone);
+    void add(int metric, uint32_t us);
+    int getCSV(char* buf, int len);
+
+  private:
+    zoneHist _hist[NUM_MT];
+    uint32_t _posted[NUM_MT][METRIC_BUCKETS];  // counts at the last getCSV()
+    volatile uint32_t _epoch;
+    int _zone[NUM_ZS];         // open zone for each task (ZS_ slot)
+    uint32_t _start[NUM_ZS];   // when it opened (usecs)
+};
+
+extern ZoneMetrics zoneMetrics;
+#endif
@@ -0,0 +1,170 @@
+#include <ctype.h>
+#include "hal/Arduino.h"
+#include "../Config.h"
+#include "../WInputs.h"
+#include "../Telemetry.h"
+
+/***********************************************************************************************
+* Roof4Dec.cpp: decoder for the binary report format (TOPIC_BIN), with a round-trip self test *
+*                                                                                              *
+* Version: 0.1                                                                                 *
+* Last updated: 17/10/2026                                                                     *
+* Author: Jim Gunther                                                                          *
+*                                                                                              *
+* Usage: roof4dec [file]     decodes "x<hex>" payloads (one per line, e.g. the sim's output,   *
+*                            or mosquitto_sub -F '%t x%x') to the CSV the Pi already reads      *
+*                            Binary batches (ws/batch) are decoded to one line per report      *
+*        roof4dec --selftest encodes and decodes random reports; exit status 1 on any mismatch *
+***********************************************************************************************/
+
+static int hexToBytes(const char* hex, uint8_t* buf, int len) {
+  int n = 0;
+  while ((n < len) && isxdigit((unsigned char)hex[0]) && isxdigit((unsigned char)hex[1])) {
+    unsigned v;
+    sscanf(hex, "%2x", &v);
+    buf[n++] = (uint8_t)v;
+    hex += 2;
+  }
+  return n;
+}
+
+static void printReport(const char* prefix, const report& rep, uint8_t flags) {
+  char freqBuf[FREQBUF_LEN];
+  char starBuf[STARBUF_LEN];
+  printf("%sseq=%u ms=%lu", prefix, (unsigned)rep.seq, rep.millis);
+  char statsBuf[STATSBUF_LEN];
+  if (flags & BIN_PEAK) printf(" peak=%.2f", rep.peak);
+  if (flags & BIN_FREQ) {
+    WInputs::getFreqCSV(rep, freqBuf);
+    printf(" csv=$%s", freqBuf);
+  }
+  if (flags & BIN_STAR) {
+    WInputs::getStarCSV(rep, starBuf);
+    printf(" star=$%s", starBuf);
+  }
+  if ((flags & BIN_STATS) && (WInputs::getStatsCSV(rep, statsBuf) > 0)) printf(" stats=$%s", statsBuf);
+  if (flags & BIN_WIND) {
+    WInputs::getWindCSV(rep, statsBuf);
+    printf(" wind=$%s", statsBuf);
+  }
+  if (flags & BIN_PROF) printf(" prof=%c secs=%u", PROF_TAGS[rep.profile % NUM_PROFILES], (unsigned)rep.secs);
+  putchar('\n');
+}
+
+/*****************************************************************************************************
+decodeBatch(): prints each report in a binary batch (see Batcher.h) with its age at posting
+parameters: prefix: const char*, buf: const uint8_t*, len: int
+returns: bool: false if the batch is malformed
+*****************************************************************************************************/
+static bool decodeBatch(const char* prefix, const uint8_t* buf, int len) {
+  uint32_t count, now, n;
+  int pos = 1;
+  if (!Telemetry::getU(buf, len, pos, count) || !Telemetry::getU(buf, len, pos, now)) return false;
+  for (uint32_t i = 0; i < count; i++) {
+    report rep;
+    uint8_t flags;
+    char recPrefix[160];
+    if (!Telemetry::getU(buf, len, pos, n) || (pos + (int)n > len)) return false;
+    if (Telemetry::decode(buf + pos, n, rep, &flags) != (int)n) return false;
+    snprintf(recPrefix, sizeof(recPrefix), "%s[%u/%u age=%lums] ", prefix, (unsigned)i + 1, (unsigned)count, (unsigned long)(now - rep.millis));
+    printReport(recPrefix, rep, flags);
+    pos += n;
+  }
+  return pos == len;
+}
+
+static uint32_t _rng = 2463534242u;
+static uint32_t rnd() {
+  _rng ^= _rng << 13;
+  _rng ^= _rng >> 17;
+  _rng ^= _rng << 5;
+  return _rng;
+}
+
+/*****************************************************************************************************
+selfTest(): random reports through encode() and decode(): values must come back to within half a
+            scale step, star counts exactly; truncated buffers must be rejected, never overrun
+parameters: none
+returns: int: number of failures
+*****************************************************************************************************/
+static int selfTest() {
+  const int32_t* scales = itemScales;
+  int fails = 0;
+  for (int n = 0; n < 20000; n++) {
+    report in, out;
+    uint8_t buf[BIN_LEN];
+    uint8_t flags = (uint8_t)(1 + rnd() % 63), gotFlags;
+    memset(&in, 0, sizeof(in));
+    in.seq = rnd();
+    in.millis = rnd();
+    for (int i = 0; i < NUM_ITEMS; i++) in.val[i] = (float)((int32_t)(rnd() % 2000000) - 1000000) / scales[i];
+    in.present = (n & 2) ? ITEMS_ALL : (uint16_t)(rnd() & ITEMS_ALL);
+    for (int i = 0; i < NUM_SHIFT7; i++) in.wd7[i] = (rnd() % 3) ? 0 : (int)(rnd() % ((n & 1) ? 100 : 100000));
+    in.peak = (float)(rnd() % 100000) * 0.01f;
+    in.wd.mean = (float)(rnd() % 3600) * 0.1f;
+    in.wd.steady = (float)(rnd() % 1001) * 0.001f;
+    in.wd.modal = (int)(rnd() % (CALM + 1));
+    in.profile = (uint8_t)(rnd() % NUM_PROFILES);
+    in.secs = (uint16_t)(rnd() % 3600);
+    for (int i = 0; i < NUM_ITEMS; i++) {
+      if (rnd() % 3 == 0) continue;
+      in.st[i].n = (uint16_t)(1 + rnd() % 1000);
+      in.st[i].min = (float)((int32_t)(rnd() % 200000) - 100000) / scales[i];
+      in.st[i].max = in.st[i].min + (float)(rnd() % 100000) / scales[i];
+      in.st[i].sd = (float)(rnd() % 10000) / scales[i];
+    }
+    int len = Telemetry::encode(in, flags, buf, BIN_LEN);
+    if ((len <= 0) || (Telemetry::decode(buf, len, out, &gotFlags) != len) || (gotFlags != flags)) {
+      fails++;
+      continue;
+    }
+    bool ok = (out.seq == in.seq) && (out.millis == in.millis);
+    if (flags & BIN_FREQ) ok = ok && (out.present == in.present);
+    for (int i = 0; (flags & BIN_FREQ) && (i < NUM_ITEMS); i++) {
+      if (in.present & (1 << i)) ok = ok && (fabsf(out.val[i] - in.val[i]) <= 0.5f / scales[i] + 1e-3f);
+    }
+    for (int i = 0; (flags & BIN_STAR) && (i < NUM_SHIFT7); i++) ok = ok && (out.wd7[i] == in.wd7[i]);
+    if (flags & BIN_PEAK) ok = ok && (fabsf(out.peak - in.peak) <= 0.006f);
+    if (flags & BIN_WIND) {
+      ok = ok && (fabsf(out.wd.mean - in.wd.mean) <= 0.06f) && (fabsf(out.wd.steady - in.wd.steady) <= 0.0006f) &&
+           (out.wd.modal == in.wd.modal);
+    }
+    if (flags & BIN_PROF) ok = ok && (out.profile == in.profile) && (out.secs == in.secs);
+    for (int i = 0; (flags & BIN_STATS) && (i < NUM_ITEMS); i++) {
+      float tol = 0.5f / scales[i] + 1e-2f;
+      ok = ok && (out.st[i].n == in.st[i].n) && (fabsf(out.st[i].min - in.st[i].min) <= tol) &&
+           (fabsf(out.st[i].max - in.st[i].max) <= 2 * tol) && (fabsf(out.st[i].sd - in.st[i].sd) <= tol);
+    }
+    for (int cut = 0; ok && (cut < len); cut++) ok = Telemetry::decode(buf, cut, out, NULL) < 0;
+    for (int cut = 0; ok && (cut < len); cut++) ok = Telemetry::encode(in, flags, buf, cut) < 0;
+    if (!ok) fails++;
+  }
+  printf("selftest: %d failures\n", fails);
+  return fails;
+}
+
+int main(int argc, char** argv) {
+  if ((argc > 1) && (strcmp(argv[1], "--selftest") == 0)) return selfTest() ? 1 : 0;
+  FILE* f = (argc > 1) ? fopen(argv[1], "r") : stdin;
+  if (f == NULL) {
+    perror(argv[1]);
+    return 2;
+  }
+  char line[2 * BATCH_BYTES + 256];
+  while (fgets(line, sizeof(line), f)) {
+    char* hex = strstr(line, " x");
+    if (hex == NULL) continue;
+    *hex = '\0';
+    uint8_t buf[BATCH_BYTES];
+    int len = hexToBytes(hex + 2, buf, BATCH_BYTES);
+    report rep;
+    uint8_t flags;
+    char prefix[128];
+    snprintf(prefix, sizeof(prefix), "%.100s ", line);
+    if ((len > 0) && (buf[0] == BIN_BATCH)) {
+      if (!decodeBatch(prefix, buf, len)) printf("%sbad batch\n", prefix);
+    } else if (Telemetry::decode(buf, len, rep, &flags) < 0) printf("%sbad payload\n", prefix);
+    else printReport(prefix, rep, flags);
+  }
+  return 0;
+}
@@ -0,0 +1,264 @@
+#include <vector>
+#include <chrono>
+#include "hal/Arduino.h"
+#include "../Config.h"
+#include "SimZones.h"
+
+/***********************************************************************************************
+* Sim.cpp: host-side replay harness for Roof4: runs the real setup() and task bodies against a *
+*          recorded or synthetic trace on a virtual clock, much faster than real time          *
+*                                                                                              *
+* Version: 0.2                                                                                 *
+* Last updated: 17/10/2026                                                                     *
+* Author: Jim Gunther                                                                          *
+*                                                                                              *
+* Usage: roof4sim [-t trace] [-s secs] [-d secs] [-r rptIntvl] [--seed n] [-w trace] [-o out]
+*                 [-m start:secs] [-i start:secs:mask] [-u start:kbytes[:bad]] [-c start:payload]
+*                 [-f dir] [-v]
+*   -t  replay a trace file             -s  synthesise secs of weather instead
+*   -d  stop after secs (default: end of trace)
+*   -r  report interval the fake RPi returns on ws/setup (loops, default 120)
+*   -w  write the trace that was used   -o  payload output file (default stdout)
+*   -m  take the MQTT broker down at start (secs) for secs (may be repeated)
+*   -i  I2C fault (SimWorld::i2cFault mask) at start (secs) for secs (may be repeated)
+*   -u  firmware upload of kbytes at start (secs); with :1 its hash does not match
+*   -c  publish payload retained on ws/config at start (secs) (may be repeated)
+*   -f  directory standing in for the flash file system (default build; emptied first)
+*   -v  echo the sketch's Serial output to stderr
+*
+* Trace format: one event per line, "#" starts a comment; times in microseconds
+*   <t> R                 anemometer revolution      <t> T           rain gauge reed edge
+*   <t> V <adc>           vane ADC value             <t> S <adc>     supply ADC value
+*   <t> A <degC> <%RH>    AHT20 reading              <t> B <Pa>      BMP180 pressure
+*   <t> L <luxA> <luxB>   BH1750 readings
+*   <t> M <0|1>           MQTT broker down/up        <t> W <0|1>     Wi-Fi down/up
+*   <t> I <mask>          I2C faults (0: none)       <t> U <bytes> <bad>  firmware upload
+*   <t> C <payload>       retained ws/config payload (rest of the line)
+* Output: "<virtual ms> <topic> <payload>" per publish, then a per-zone timing table on stderr.
+*
+* The sampling task (sampleTick) runs at each LOOP_TIME tick, pre-empting the network task
+* (netTick, every NET_TICK) as it would from the other core; the OTA task (otaTick, every
+* OTA_TICK) runs after the network task, as it would below it on the same core.
+***********************************************************************************************/
+
+void setup();
+void sampleTick();
+void netTick();
+void otaTick();
+
+static const char* zoneNames[NUM_ZT] = { "every", "wd", "blink", "report", "ota", "mqtt", "reconn", "publish", "i2c" };
+
+static uint64_t _rng = 88172645463325252ULL;
+
+static double rnd() {  // xorshift64: same sequence on every host for a given seed
+  _rng ^= _rng << 13;
+  _rng ^= _rng >> 7;
+  _rng ^= _rng << 17;
+  return (_rng >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/*****************************************************************************************************
+synthesise(): makes a deterministic trace of gusty wind, showers, a wandering vane and slow
+              sensor drift
+parameters: ev: vector to fill, secs: double: length of trace
+returns: void
+*****************************************************************************************************/
+static void synthesise(std::vector<SimEvent>& ev, double secs) {
+  uint64_t end = (uint64_t)(secs * 1e6);
+  // anemometer: mean speed wanders between calm and ~6 revs/sec, with 3-10 sec gusts on top
+  double t = 0.0, gust = 0.0, gustEnd = 0.0;
+  while (t < end) {
+    double mean = 2.5 + 2.0 * sin(t * 2e-9) + 1.5 * sin(t * 1.3e-8);
+    if (t > gustEnd) {
+      gust = (rnd() < 0.3) ? 2.0 + 4.0 * rnd() : 0.0;
+      gustEnd = t + 3e6 + 7e6 * rnd();
+    }
+    double rps = mean + gust + 0.3 * (rnd() - 0.5);
+    if (rps < 0.05) {  // calm: look again in half a second
+      t += 5e5;
+      continue;
+    }
+    t += 1e6 / rps;
+    ev.push_back({ (uint64_t)t, 'R', 0, 0 });
+  }
+  // rain: showers of a few minutes, two reed edges per bucket tip
+  t = 0.0;
+  while (t < end) {
+    t += 6e8 * rnd();
+    double showerEnd = t + 1.2e8 + 2.4e8 * rnd();
+    double tipGap = 5e6 + 6e7 * rnd();
+    while ((t < showerEnd) && (t < end)) {
+      ev.push_back({ (uint64_t)t, 'T', 0, 0 });
+      ev.push_back({ (uint64_t)t + 40000, 'T', 0, 0 });
+      t += tipGap * (0.5 + rnd());
+    }
+  }
+  // vane, supply and I2C sensors: a sample every second
+  double vane = 2048.0;
+  for (uint64_t s = 0; s < end; s += 1000000) {
+    double h = s * 1e-6 / 3600.0;
+    vane += 90.0 * (rnd() - 0.5);
+    vane = max(0.0, min(4095.0, vane));
+    ev.push_back({ s, 'V', (float)(int)vane, 0 });
+    ev.push_back({ s, 'S', (float)(int)(2900 + 20 * (rnd() - 0.5)), 0 });
+    ev.push_back({ s, 'A', (float)(10.0 + 5.0 * sin(h * 0.26)), (float)(75.0 - 10.0 * sin(h * 0.26)) });
+    ev.push_back({ s, 'B', (float)(101325.0 + 300.0 * sin(h * 0.1)), 0 });
+    double lux = max(0.0, 20000.0 * sin((h - 6.0) * 0.26));
+    ev.push_back({ s, 'L', (float)lux, (float)(lux * 0.9) });
+  }
+  std::stable_sort(ev.begin(), ev.end(), [](const SimEvent& a, const SimEvent& b) { return a.tUs < b.tUs; });
+}
+
+static bool readTrace(const char* path, std::vector<SimEvent>& ev) {
+  FILE* f = fopen(path, "r");
+  if (f == nullptr) return false;
+  char line[256];
+  while (fgets(line, sizeof(line), f)) {
+    unsigned long long t;
+    char kind;
+    float v1 = 0, v2 = 0;
+    if ((line[0] == '#') || (sscanf(line, "%llu %c %f %f", &t, &kind, &v1, &v2) < 2)) continue;
+    if (kind == 'C') {  // the payload is the rest of the line
+      if (simNumConfigs == SIM_MAX_CONFIGS) continue;
+      char* p = strchr(line, 'C') + 1;
+      p += strspn(p, " ");
+      p[strcspn(p, "\r\n")] = '\0';
+      v1 = (float)simNumConfigs;
+      simConfigs[simNumConfigs++] = strdup(p);
+    }
+    ev.push_back({ (uint64_t)t, kind, v1, v2 });
+  }
+  fclose(f);
+  std::stable_sort(ev.begin(), ev.end(), [](const SimEvent& a, const SimEvent& b) { return a.tUs < b.tUs; });
+  return true;
+}
+
+static void writeTrace(const char* path, const std::vector<SimEvent>& ev) {
+  FILE* f = fopen(path, "w");
+  if (f == nullptr) return;
+  for (const SimEvent& e : ev) {
+    if ((e.kind == 'R') || (e.kind == 'T')) fprintf(f, "%llu %c\n", (unsigned long long)e.tUs, e.kind);
+    else if (e.kind == 'C') fprintf(f, "%llu C %s\n", (unsigned long long)e.tUs, simConfigs[(int)e.v1]);
+    else fprintf(f, "%llu %c %g %g\n", (unsigned long long)e.tUs, e.kind, e.v1, e.v2);
+  }
+  fclose(f);
+}
+
+static void printZones(double realSecs) {
+  fprintf(stderr, "virtual %.1f s in %.3f s real (x%.0f)\n", simNowUs * 1e-6, realSecs,
+          realSecs > 0 ? simNowUs * 1e-6 / realSecs : 0.0);
+  fprintf(stderr, "sample tick lateness: mean %.1f us, max %.1f us over %llu ticks\n",
+          simPeriodicRuns ? (double)simLatenessSumUs / simPeriodicRuns : 0.0, (double)simLatenessMaxUs,
+          (unsigned long long)simPeriodicRuns);
+  fprintf(stderr, "%-8s %10s %12s %10s %12s %10s\n", "zone", "calls", "cpu us", "max us", "virt ms", "max ms");
+  for (int i = 0; i < NUM_ZT; i++) {
+    const SimZoneStat& z = simZones[i];
+    fprintf(stderr, "%-8s %10llu %12.1f %10.1f %12.1f %10.1f\n", zoneNames[i], (unsigned long long)z.calls,
+            z.cpuNs * 1e-3, z.cpuMaxNs * 1e-3, z.virtUs * 1e-3, z.virtMaxUs * 1e-3);
+  }
+}
+
+int main(int argc, char** argv) {
+  const char* tracePath = nullptr;
+  const char* writePath = nullptr;
+  std::vector<SimEvent> outages;
+  double synthSecs = 0.0, runSecs = 0.0;
+  for (int i = 1; i < argc; i++) {
+    const char* a = argv[i];
+    const char* v = (i + 1 < argc) ? argv[i + 1] : nullptr;
+    if (strcmp(a, "-v") == 0) {
+      simVerbose = true;
+      continue;
+    }
+    if (v == nullptr) {
+      fprintf(stderr, "missing value for %s\n", a);
+      return 2;
+    }
+    i++;
+    if (strcmp(a, "-t") == 0) tracePath = v;
+    else if (strcmp(a, "-s") == 0) synthSecs = atof(v);
+    else if (strcmp(a, "-d") == 0) runSecs = atof(v);
+    else if (strcmp(a, "-r") == 0) simRptIntvl = atoi(v);
+    else if (strcmp(a, "-w") == 0) writePath = v;
+    else if (strcmp(a, "-f") == 0) simFsDir = v;
+    else if (strcmp(a, "-m") == 0) {
+      double start = atof(v), secs = strchr(v, ':') ? atof(strchr(v, ':') + 1) : 60.0;
+      outages.push_back({ (uint64_t)(start * 1e6), 'M', 0, 0 });
+      outages.push_back({ (uint64_t)((start + secs) * 1e6), 'M', 1, 0 });
+    }
+    else if (strcmp(a, "-i") == 0) {
+      const char* s = strchr(v, ':');
+      const char* m = s ? strchr(s + 1, ':') : nullptr;
+      double start = atof(v), secs = s ? atof(s + 1) : 60.0;
+      float mask = m ? (float)strtol(m + 1, nullptr, 0) : 16.0f;
+      outages.push_back({ (uint64_t)(start * 1e6), 'I', mask, 0 });
+      outages.push_back({ (uint64_t)((start + secs) * 1e6), 'I', 0, 0 });
+    }
+    else if (strcmp(a, "-u") == 0) {
+      const char* s = strchr(v, ':');
+      const char* b = s ? strchr(s + 1, ':') : nullptr;
+      double start = atof(v), kbytes = s ? atof(s + 1) : 1024.0;
+      outages.push_back({ (uint64_t)(start * 1e6), 'U', (float)(kbytes * 1024), b ? (float)atoi(b + 1) : 0.0f });
+    }
+    else if (strcmp(a, "-c") == 0) {
+      const char* s = strchr(v, ':');
+      if ((s == nullptr) || (simNumConfigs == SIM_MAX_CONFIGS)) {
+        fprintf(stderr, "bad -c %s\n", v);
+        return 2;
+      }
+      outages.push_back({ (uint64_t)(atof(v) * 1e6), 'C', (float)simNumConfigs, 0 });
+      simConfigs[simNumConfigs++] = s + 1;
+    }
+    else if (strcmp(a, "--seed") == 0) _rng = strtoull(v, nullptr, 0) | 1;
+    else if (strcmp(a, "-o") == 0) {
+      simOut = fopen(v, "w");
+      if (simOut == nullptr) {
+        perror(v);
+        return 2;
+      }
+    } else {
+      fprintf(stderr, "unknown option %s\n", a);
+      return 2;
+    }
+  }
+
+  std::vector<SimEvent> events;
+  if (tracePath != nullptr) {
+    if (!readTrace(tracePath, events)) {
+      perror(tracePath);
+      return 2;
+    }
+  } else {
+    synthesise(events, synthSecs > 0.0 ? synthSecs : 600.0);
+  }
+  events.insert(events.end(), outages.begin(), outages.end());
+  std::stable_sort(events.begin(), events.end(), [](const SimEvent& a, const SimEvent& b) { return a.tUs < b.tUs; });
+  if (writePath != nullptr) writeTrace(writePath, events);
+  char logPath[256];
+  snprintf(logPath, sizeof(logPath), "%s%s", simFsDir, LOG_FILE);
+  remove(logPath);
+  if (runSecs <= 0.0) runSecs = events.empty() ? 600.0 : events.back().tUs * 1e-6;
+  uint64_t endUs = (uint64_t)(runSecs * 1e6);
+  simLoadEvents(events.data(), (int)events.size());
+
+  auto t0 = std::chrono::steady_clock::now();
+  try {
+    setup();
+    simSetPeriodic(sampleTick, (uint64_t)LOOP_TIME * 1000);
+    uint64_t otaDue = 0;
+    while (simNowUs < endUs) {
+      netTick();
+      if (simNowUs >= otaDue) {
+        otaTick();
+        otaDue = simNowUs + (uint64_t)OTA_TICK * 1000;
+      }
+      simAdvanceUs((uint64_t)NET_TICK * 1000);
+    }
+  } catch (const SimRestartEx&) {
+  }
+  simZone(ZT_IDLE);
+  double realSecs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+  fflush(simOut);
+  printZones(realSecs);
+  return 0;
+}
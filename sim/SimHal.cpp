@@ -0,0 +1,522 @@
+#include <time.h>
+#include <malloc.h>
+#include "hal/Arduino.h"
+#include "hal/Wire.h"
+#include "hal/WiFi.h"
+#include "hal/PubSubClient.h"
+#include "hal/ESPmDNS.h"
+#include "hal/Update.h"
+#include "hal/WebServer.h"
+#include "hal/mbedtls/sha256.h"
+#include "hal/LittleFS.h"
+#include "hal/driver/pulse_cnt.h"
+#include "../Config.h"
+#include "SimZones.h"
+
+/***********************************************************************************************
+* SimHal.cpp: virtual clock, event replay and the stubs' shared state                          *
+*                                                                                              *
+* Version: 0.1                                                                                 *
+* Last updated: 17/10/2026                                                                     *
+* Author: Jim Gunther                                                                          *
+*                                                                                              *
+***********************************************************************************************/
+
+SimWorld simWorld;
+uint64_t simNowUs = 0;
+bool simVerbose = false;
+FILE* simOut = stdout;
+int simRptIntvl = 120;
+
+HardwareSerial Serial;
+EspClass ESP;
+TwoWire Wire;
+WiFiClass WiFi;
+int simWifiScans = 0;
+int simWifiDirect = 0;
+MDNSResponder MDNS;
+UpdateClass Update;
+LittleFSFS LittleFS;
+const char* simFsDir = "build";
+const char* simConfigs[SIM_MAX_CONFIGS];
+int simNumConfigs = 0;
+
+/*****************************************************************************************************
+EspClass heap figures: SIM_HEAP bytes less what the host allocator has handed out since the first call
+(and not had back); the largest block is taken as half the free heap
+*****************************************************************************************************/
+#define SIM_HEAP 200000
+static size_t _heapBase = 0;
+static uint32_t _heapMin = SIM_HEAP;
+
+uint32_t EspClass::getFreeHeap() {
+  size_t used = mallinfo2().uordblks;
+  if (_heapBase == 0) _heapBase = used;
+  long free = SIM_HEAP - ((long)used - (long)_heapBase);
+  if (free < 0) free = 0;
+  if ((uint32_t)free < _heapMin) _heapMin = (uint32_t)free;
+  return (uint32_t)free;
+}
+
+uint32_t EspClass::getMaxAllocHeap() { return getFreeHeap() / 2; }
+
+uint32_t EspClass::getMinFreeHeap() {
+  getFreeHeap();
+  return _heapMin;
+}
+
+static SimEvent* _events = nullptr;
+static int _numEvents = 0;
+static int _nextEvent = 0;
+
+#define SIM_PINS 40
+static void (*_isr[SIM_PINS])() = {};
+static int _isrMode[SIM_PINS] = {};
+static int _pinOut[SIM_PINS] = {};
+
+void simLoadEvents(SimEvent* ev, int count) {
+  _events = ev;
+  _numEvents = count;
+  _nextEvent = 0;
+}
+
+void simAttachIsr(int pin, void (*fn)(), int mode) {
+  _isr[pin] = fn;
+  _isrMode[pin] = mode;
+}
+
+// PCNT driver stub ----------------------------------------------------------------------------------
+
+#define SIM_PCNT_UNITS 4
+struct SimPcntUnit {
+  int high;
+  uint32_t glitchNs;
+  int pin;
+  pcnt_channel_edge_action_t pos, neg;
+  bool running;
+  int count;
+  uint64_t lastEdgeUs;
+};
+static SimPcntUnit _pcnt[SIM_PCNT_UNITS];
+static int _numPcnt = 0;
+
+esp_err_t pcnt_new_unit(const pcnt_unit_config_t* config, pcnt_unit_handle_t* unit) {
+  if ((_numPcnt == SIM_PCNT_UNITS) || (config->low_limit >= 0) || (config->high_limit <= 0)) return ESP_FAIL;
+  SimPcntUnit& u = _pcnt[_numPcnt++];
+  u = SimPcntUnit();
+  u.high = config->high_limit;
+  u.pin = -1;
+  *unit = &u;
+  return ESP_OK;
+}
+
+esp_err_t pcnt_unit_set_glitch_filter(pcnt_unit_handle_t unit, const pcnt_glitch_filter_config_t* config) {
+  unit->glitchNs = config->max_glitch_ns;
+  return ESP_OK;
+}
+
+esp_err_t pcnt_new_channel(pcnt_unit_handle_t unit, const pcnt_chan_config_t* config, pcnt_channel_handle_t* chan) {
+  unit->pin = config->edge_gpio_num;
+  *chan = unit;
+  return ESP_OK;
+}
+
+esp_err_t pcnt_channel_set_edge_action(pcnt_channel_handle_t chan, pcnt_channel_edge_action_t pos,
+                                       pcnt_channel_edge_action_t neg) {
+  chan->pos = pos;
+  chan->neg = neg;
+  return ESP_OK;
+}
+
+esp_err_t pcnt_unit_enable(pcnt_unit_handle_t) {
+  return ESP_OK;
+}
+
+esp_err_t pcnt_unit_clear_count(pcnt_unit_handle_t unit) {
+  unit->count = 0;
+  return ESP_OK;
+}
+
+esp_err_t pcnt_unit_start(pcnt_unit_handle_t unit) {
+  unit->running = true;
+  return ESP_OK;
+}
+
+esp_err_t pcnt_unit_get_count(pcnt_unit_handle_t unit, int* value) {
+  *value = unit->count;
+  return ESP_OK;
+}
+
+/*****************************************************************************************************
+simPcntEdge(): counts an edge on every running PCNT unit watching the pin; the unit clears on
+               reaching its high limit, like the hardware
+parameters: pin: int, rising: bool
+returns: void
+*****************************************************************************************************/
+static void simPcntEdge(int pin, bool rising) {
+  for (int i = 0; i < _numPcnt; i++) {
+    SimPcntUnit& u = _pcnt[i];
+    if (!u.running || (u.pin != pin)) continue;
+    bool glitch = (simNowUs - u.lastEdgeUs) * 1000 < u.glitchNs;
+    u.lastEdgeUs = simNowUs;
+    if (glitch) continue;
+    pcnt_channel_edge_action_t act = rising ? u.pos : u.neg;
+    if (act == PCNT_CHANNEL_EDGE_ACTION_INCREASE) u.count++;
+    else if (act == PCNT_CHANNEL_EDGE_ACTION_DECREASE) u.count--;
+    if (u.count >= u.high) u.count = 0;
+  }
+}
+
+/*****************************************************************************************************
+fireEdge(): calls a pin's ISR if its trigger mode matches the edge
+parameters: pin: int, rising: bool
+returns: void
+*****************************************************************************************************/
+static void fireEdge(int pin, bool rising) {
+  simPcntEdge(pin, rising);
+  if (_isr[pin] == nullptr) return;
+  int mode = _isrMode[pin];
+  if ((mode == CHANGE) || (rising && (mode == RISING)) || (!rising && (mode == FALLING))) _isr[pin]();
+}
+
+static void applyEvent(const SimEvent& e) {
+  switch (e.kind) {
+    case 'R':  // one anemometer revolution: a short pulse
+      fireEdge(RevsPin, true);
+      fireEdge(RevsPin, false);
+      break;
+    case 'T':  // reed switch edge as the bucket tips
+      simWorld.rainLevel = !simWorld.rainLevel;
+      fireEdge(RainPin, simWorld.rainLevel);
+      break;
+    case 'V':
+      simWorld.vaneAdc = (int)e.v1;
+      break;
+    case 'S':
+      simWorld.voltsAdc = (int)e.v1;
+      break;
+    case 'A':
+      simWorld.tempC = e.v1;
+      simWorld.humidity = e.v2;
+      break;
+    case 'B':
+      simWorld.pressurePa = e.v1;
+      break;
+    case 'U':
+      simWorld.uploadBytes = (uint32_t)e.v1;
+      simWorld.uploadBad = (e.v2 != 0);
+      break;
+    case 'C':
+      if (((int)e.v1 < 0) || ((int)e.v1 >= simNumConfigs)) break;
+      simWorld.configIx = (int)e.v1;
+      simWorld.configSeq++;
+      break;
+    case 'L':
+      simWorld.luxA = e.v1;
+      simWorld.luxB = e.v2;
+      break;
+    case 'M':
+      simWorld.brokerUp = e.v1 != 0.0f;
+      break;
+    case 'W':
+      simWorld.wifiUp = e.v1 != 0.0f;
+      break;
+    case 'I':
+      simWorld.i2cFault = (int)e.v1;
+      break;
+    default:
+      break;
+  }
+}
+
+// Periodic task (the sampling task): runs whenever its next tick falls due, pre-empting
+// whatever the network task was doing, like a higher-priority task on the other core would
+static void (*_periodic)() = nullptr;
+static uint64_t _periodUs = 0;
+static uint64_t _nextDueUs = 0;
+static bool _inPeriodic = false;
+uint64_t simLatenessMaxUs = 0;
+uint64_t simLatenessSumUs = 0;
+uint64_t simPeriodicRuns = 0;
+
+void simSetPeriodic(void (*fn)(), uint64_t periodUs) {
+  _periodic = fn;
+  _periodUs = periodUs;
+  _nextDueUs = simNowUs;
+}
+
+static void advanceTo(uint64_t target) {
+  while ((_nextEvent < _numEvents) && (_events[_nextEvent].tUs <= target)) {
+    if (_events[_nextEvent].tUs > simNowUs) simNowUs = _events[_nextEvent].tUs;
+    applyEvent(_events[_nextEvent++]);
+  }
+  if (target > simNowUs) simNowUs = target;
+}
+
+// the periodic (sampling) task stands for the sketch's core 1 task, everything else for core 0
+int simCoreId() {
+  return _inPeriodic ? 1 : 0;
+}
+
+static void runPeriodic() {
+  uint64_t late = simNowUs - _nextDueUs;
+  simPeriodicRuns++;
+  simLatenessSumUs += late;
+  if (late > simLatenessMaxUs) simLatenessMaxUs = late;
+  _inPeriodic = true;
+  simZoneSuspend();
+  _periodic();
+  simZoneResume();
+  _inPeriodic = false;
+  // like vTaskDelayUntil(): a late tick does not push the following ones back
+  _nextDueUs += _periodUs;
+  while (_nextDueUs + _periodUs <= simNowUs) _nextDueUs += _periodUs;
+}
+
+/*****************************************************************************************************
+simAdvanceUs(): moves the virtual clock on, replaying every event that falls due on the way and
+                running the periodic task at each of its ticks
+parameters: us: uint64_t: microseconds to advance
+returns: void
+*****************************************************************************************************/
+void simAdvanceUs(uint64_t us) {
+  uint64_t target = simNowUs + us;
+  while ((_periodic != nullptr) && !_inPeriodic && (_nextDueUs <= target)) {
+    advanceTo(_nextDueUs);
+    runPeriodic();
+  }
+  advanceTo(target);
+}
+
+void simRestart() {
+  fprintf(simOut, "%llu RESTART\n", (unsigned long long)(simNowUs / 1000));
+  throw SimRestartEx();
+}
+
+void pinMode(int, int) {}
+
+int digitalRead(int pin) {
+  if (pin == RainPin) return simWorld.rainLevel;
+  if (pin == SDAPin) return (simWorld.i2cFault & 16) ? LOW : HIGH;
+  return _pinOut[pin];
+}
+
+void digitalWrite(int pin, int val) {
+  static int clocks = 0;
+  if ((pin == SCLPin) && val && !_pinOut[pin] && (simWorld.i2cFault & 16) && (++clocks >= 3)) {
+    simWorld.i2cFault &= ~16;  // the stuck device has finished its byte and lets SDA go
+    clocks = 0;
+  }
+  _pinOut[pin] = val;
+}
+
+int analogRead(int pin) {
+  if (pin == WDPin) return simWorld.vaneAdc;
+  if (pin == VoltsPin) return simWorld.voltsAdc;
+  return 0;
+}
+
+/*****************************************************************************************************
+WebServer::handleClient(): runs a waiting upload as the real server would: the page's hash in the
+query, then the image in chunks arriving at SIM_UPLOAD_BPS, then the reply. Byte i of the image is
+(i * 31 + 7) & 0xff.
+parameters: none
+returns: void
+*****************************************************************************************************/
+#define SIM_UPLOAD_BPS 100000
+static uint8_t simImageByte(uint32_t i) { return (uint8_t)((i * 31 + 7) & 0xff); }
+
+void WebServer::handleClient() {
+  if ((simWorld.uploadBytes == 0) || !_upFn) return;
+  uint32_t total = simWorld.uploadBytes;
+  simWorld.uploadBytes = 0;
+  mbedtls_sha256_context sha;
+  uint8_t digest[32];
+  mbedtls_sha256_init(&sha);
+  mbedtls_sha256_starts(&sha, 0);
+  for (uint32_t i = 0; i < total; i++) {
+    uint8_t b = simImageByte(i);
+    mbedtls_sha256_update(&sha, &b, 1);
+  }
+  mbedtls_sha256_finish(&sha, digest);
+  for (int i = 0; i < 32; i++) snprintf(_sha + 2 * i, 3, "%02x", digest[i]);
+  if (simWorld.uploadBad) _sha[0] = (_sha[0] == '0') ? '1' : '0';
+
+  _upload.filename = String("roof4.ino.bin");
+  _upload.totalSize = 0;
+  _upload.status = UPLOAD_FILE_START;
+  _upFn();
+  for (uint32_t off = 0; off < total; off += _upload.currentSize) {
+    _upload.currentSize = min((size_t)(total - off), sizeof(_upload.buf));
+    for (size_t i = 0; i < _upload.currentSize; i++) _upload.buf[i] = simImageByte(off + i);
+    simAdvanceUs((uint64_t)_upload.currentSize * 1000000 / SIM_UPLOAD_BPS);
+    _upload.status = UPLOAD_FILE_WRITE;
+    _upFn();
+    _upload.totalSize += _upload.currentSize;
+  }
+  _upload.status = UPLOAD_FILE_END;
+  _upFn();
+  _postFn();
+}
+
+static adc_continuous_data_t _adcFrame[2];
+static int _adcPins = 0;
+static uint64_t _adcFrameUs = 0;  // how long a frame takes to fill
+static uint64_t _adcNextUs = 0;   // when the oldest one kept is full (0: stopped)
+#define SIM_ADC_KEEP 2            // frames the driver keeps: older ones are overwritten
+
+bool analogContinuous(const uint8_t pins[], size_t pins_count, uint32_t conversions_per_pin, uint32_t sampling_freq_hz,
+                      void (*)(void)) {
+  if ((pins_count < 1) || (pins_count > 2) || (sampling_freq_hz == 0)) return false;
+  _adcPins = (int)pins_count;
+  for (int i = 0; i < _adcPins; i++) _adcFrame[i].pin = pins[i];
+  _adcFrameUs = (uint64_t)conversions_per_pin * pins_count * 1000000 / sampling_freq_hz;
+  return true;
+}
+
+bool analogContinuousStart() {
+  if (_adcPins == 0) return false;
+  _adcNextUs = simNowUs + _adcFrameUs;
+  return true;
+}
+
+bool analogContinuousDeinit() {
+  _adcPins = 0;
+  _adcNextUs = 0;
+  return true;
+}
+
+// The oldest frame the driver still keeps, one per call as the driver hands them over
+bool analogContinuousRead(adc_continuous_data_t** buffer, uint32_t) {
+  if ((_adcNextUs == 0) || (simNowUs < _adcNextUs)) return false;
+  while (_adcNextUs + SIM_ADC_KEEP * _adcFrameUs <= simNowUs) _adcNextUs += _adcFrameUs;
+  _adcNextUs += _adcFrameUs;
+  for (int i = 0; i < _adcPins; i++) {
+    _adcFrame[i].avg_read_raw = analogRead(_adcFrame[i].pin);
+    _adcFrame[i].avg_read_mvolts = _adcFrame[i].avg_read_raw * 3300 / 4096;
+  }
+  *buffer = _adcFrame;
+  return true;
+}
+
+/*****************************************************************************************************
+simPublish(): writes one MQTT publish to the sim output as "<ms> <topic> <payload>"; binary
+              payloads are written as "x" and hex
+parameters: topic: const char*, payload: const uint8_t*, len: unsigned int
+returns: void
+*****************************************************************************************************/
+void simPublish(const char* topic, const uint8_t* payload, unsigned int len) {
+  bool text = true;
+  for (unsigned int i = 0; i < len; i++) {
+    if ((payload[i] < 0x20) || (payload[i] > 0x7e)) text = false;
+  }
+  fprintf(simOut, "%llu %s ", (unsigned long long)(simNowUs / 1000), topic);
+  if (text) {
+    fwrite(payload, 1, len, simOut);
+  } else {
+    fputc('x', simOut);
+    for (unsigned int i = 0; i < len; i++) fprintf(simOut, "%02x", payload[i]);
+  }
+  fputc('\n', simOut);
+}
+
+// PubSubClient stub ---------------------------------------------------------------------------------
+
+bool PubSubClient::subscribe(const char* topic, uint8_t) {
+  if (strcmp(topic, TOPIC_SETUP) == 0) _setupSubscribed = true;
+  if (strcmp(topic, TOPIC_CONFIG) == 0) {
+    _configSubscribed = true;
+    _configSeen = 0;  // the broker sends the retained payload to each new subscription
+  }
+  return _connected;
+}
+
+bool PubSubClient::unsubscribe(const char* topic) {
+  if (strcmp(topic, TOPIC_SETUP) == 0) _setupSubscribed = false;
+  if (strcmp(topic, TOPIC_CONFIG) == 0) _configSubscribed = false;
+  return _connected;
+}
+
+bool PubSubClient::publish(const char* topic, const uint8_t* payload, unsigned int len, bool) {
+  if (!simWorld.brokerUp || !simWorld.wifiUp) _connected = false;
+  if (!_connected) return false;
+  if (5 + 2 + strlen(topic) + len > _bufSize) return false;
+  simPublish(topic, payload, len);
+  if (strcmp(topic, TOPIC_INIT) == 0) _replyPending = true;
+  return true;
+}
+
+bool PubSubClient::loop() {
+  if (!simWorld.brokerUp || !simWorld.wifiUp) _connected = false;
+  if (_replyPending && _setupSubscribed && _callback) {
+    char reply[16];
+    int n = snprintf(reply, sizeof(reply), "I%d", simRptIntvl);
+    _replyPending = false;
+    char topic[] = TOPIC_SETUP;
+    _callback(topic, (uint8_t*)reply, n);
+  }
+  if (_connected && _configSubscribed && _callback && (_configSeen != simWorld.configSeq)) {
+    _configSeen = simWorld.configSeq;
+    char topic[] = TOPIC_CONFIG;
+    const char* payload = simConfigs[simWorld.configIx];
+    _callback(topic, (uint8_t*)payload, strlen(payload));
+  }
+  return _connected;
+}
+
+// Zone CPU accounting -------------------------------------------------------------------------------
+
+SimZoneStat simZones[SIM_MAX_ZONES];
+static int _curZone = -1;
+static uint64_t _zoneCpuStart = 0;
+static uint64_t _zoneVirtStart = 0;
+static uint64_t _zoneCpuCarry = 0;
+static uint64_t _zoneVirtCarry = 0;
+
+static uint64_t cpuNowNs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/*****************************************************************************************************
+simZone(): closes the current zone (charging it the CPU and virtual time used) and opens the next
+parameters: zone: int: the zone now starting (ZT_IDLE when the task goes idle)
+returns: void
+*****************************************************************************************************/
+void simZone(int zone) {
+  uint64_t cpu = cpuNowNs();
+  if ((_curZone >= 0) && (_curZone < SIM_MAX_ZONES)) {
+    SimZoneStat& z = simZones[_curZone];
+    uint64_t dc = cpu - _zoneCpuStart + _zoneCpuCarry;
+    uint64_t dv = simNowUs - _zoneVirtStart + _zoneVirtCarry;
+    z.calls++;
+    z.cpuNs += dc;
+    if (dc > z.cpuMaxNs) z.cpuMaxNs = dc;
+    z.virtUs += dv;
+    if (dv > z.virtMaxUs) z.virtMaxUs = dv;
+  }
+  _curZone = zone;
+  _zoneCpuCarry = 0;
+  _zoneVirtCarry = 0;
+  _zoneCpuStart = cpuNowNs();
+  _zoneVirtStart = simNowUs;
+}
+
+// The periodic task interrupts a network zone: park it so only its own time is charged
+static int _savedZone = ZT_IDLE;
+
+void simZoneSuspend() {
+  _zoneCpuCarry += cpuNowNs() - _zoneCpuStart;
+  _zoneVirtCarry += simNowUs - _zoneVirtStart;
+  _savedZone = _curZone;
+  _curZone = ZT_IDLE;
+}
+
+void simZoneResume() {
+  uint64_t cpuCarry = _zoneCpuCarry, virtCarry = _zoneVirtCarry;
+  simZone(ZT_IDLE);  // close the periodic task's last zone
+  _curZone = _savedZone;
+  _zoneCpuCarry = cpuCarry;
+  _zoneVirtCarry = virtCarry;
+}
@@ -0,0 +1,68 @@
+#ifndef SIM_HAL_H
+#define SIM_HAL_H
+#include <stdint.h>
+#include <stdio.h>
+
+/***********************************************************************************************
+* SimHal.h: host-side simulation of the ESP32 hardware used by Roof4 (virtual clock, pins,    *
+*           interrupts, I2C sensor values and MQTT capture)                                    *
+*                                                                                              *
+* Version: 0.1                                                                                 *
+* Last updated: 17/10/2026                                                                     *
+* Author: Jim Gunther                                                                          *
+*                                                                                              *
+***********************************************************************************************/
+
+// One recorded or synthetic event: replayed when the virtual clock passes tUs
+struct SimEvent {
+  uint64_t tUs;
+  char kind;    // R: anemometer pulse, T: bucket edge, V: vane ADC, S: supply ADC, A: AHT, B: BMP, L: BH1750s,
+                // M: MQTT broker up (1) / down (0), W: Wi-Fi up / down, I: I2C faults (SimWorld::i2cFault),
+                // U: firmware upload of v1 bytes (v2 non-zero: the page's hash is wrong),
+                // C: retained settings simConfigs[v1] published on TOPIC_CONFIG
+  float v1;
+  float v2;
+};
+
+// Current "physical" state seen by the sensor and pin stubs
+struct SimWorld {
+  int vaneAdc = 2048;
+  int voltsAdc = 2900;
+  int rainLevel = 1;
+  float tempC = 12.0f;
+  float humidity = 70.0f;
+  float pressurePa = 101325.0f;
+  float luxA = 500.0f;
+  float luxB = 500.0f;
+  bool brokerUp = true;
+  bool wifiUp = true;
+  uint32_t uploadBytes = 0;  // an upload waiting for the web server ...
+  bool uploadBad = false;    // ... and whether its hash will not match
+  int configIx = -1;         // retained TOPIC_CONFIG payload (simConfigs index; -1: none) ...
+  int configSeq = 0;         // ... counts publishes, so subscribers can tell a new one
+  int i2cFault = 0;  // bits: 1 BMP180, 2 AHT20, 4 BH1750a, 8 BH1750b not answering; 16 bus stuck (SDA held
+                     // low until SCL is clocked)
+};
+
+extern SimWorld simWorld;
+extern uint64_t simNowUs;
+extern bool simVerbose;
+extern FILE* simOut;
+extern int simRptIntvl;  // value the fake RPi sends back on ws/setup
+extern const char* simFsDir;  // host directory standing in for LittleFS
+#define SIM_MAX_CONFIGS 16
+extern const char* simConfigs[SIM_MAX_CONFIGS];  // TOPIC_CONFIG payloads for C events
+extern int simNumConfigs;
+
+void simAdvanceUs(uint64_t us);  // moves the virtual clock, firing any events due
+void simLoadEvents(SimEvent* ev, int count);
+void simAttachIsr(int pin, void (*fn)(), int mode);
+void simPublish(const char* topic, const uint8_t* payload, unsigned int len);
+void simSetPeriodic(void (*fn)(), uint64_t periodUs);  // a higher-priority task on another core
+void simZone(int zone);  // zone boundary marker (see ZONE_MARK in Config.h)
+bool simI2cAnswers(uint8_t addr);  // the device is there and the bus is free
+[[noreturn]] void simRestart();
+
+struct SimRestartEx {};
+
+#endif
@@ -0,0 +1,171 @@
+#include "hal/Wire.h"
+#include "../Config.h"
+
+/***********************************************************************************************
+* SimI2C.cpp: register-level AHT20 and BMP180 on the simulated I2C bus, with real conversion   *
+*             times, so the sketch's non-blocking acquisition is exercised as on the hardware  *
+*                                                                                              *
+* Version: 0.1                                                                                 *
+* Last updated: 17/10/2026                                                                     *
+* Author: Jim Gunther                                                                          *
+*                                                                                              *
+***********************************************************************************************/
+
+// BMP180 datasheet example calibration
+static const int16_t AC1 = 408, AC2 = -72, AC3 = -14383, B1 = 6190, B2 = 4, MB = -32768, MC = -8711, MD = 2868;
+static const uint16_t AC4 = 32741, AC5 = 32757, AC6 = 23153;
+
+static uint64_t _ahtStartUs = 0;
+static bool _ahtBusy = false;
+static uint8_t _bmpReg = 0;
+static uint8_t _bmpCtrl = 0;
+static uint64_t _bmpStartUs = 0;
+static int32_t _bmpOut = 0;
+
+static int32_t bmpTemp(int32_t ut, int32_t* b5out) {  // 0.1 degC
+  int32_t x1 = ((ut - (int32_t)AC6) * (int32_t)AC5) >> 15;
+  int32_t x2 = ((int32_t)MC << 11) / (x1 + MD);
+  *b5out = x1 + x2;
+  return (*b5out + 8) >> 4;
+}
+
+static int32_t bmpPres(int32_t up, int32_t b5, int oss) {  // Pa
+  int32_t b6 = b5 - 4000;
+  int32_t x1 = (B2 * ((b6 * b6) >> 12)) >> 11;
+  int32_t x2 = (AC2 * b6) >> 11;
+  int32_t x3 = x1 + x2;
+  int32_t b3 = ((((int32_t)AC1 * 4 + x3) << oss) + 2) / 4;
+  x1 = (AC3 * b6) >> 13;
+  x2 = (B1 * ((b6 * b6) >> 12)) >> 16;
+  x3 = ((x1 + x2) + 2) >> 2;
+  uint32_t b4 = ((uint32_t)AC4 * (uint32_t)(x3 + 32768)) >> 15;
+  uint32_t b7 = ((uint32_t)up - b3) * (uint32_t)(50000UL >> oss);
+  int32_t p = (b7 < 0x80000000) ? (int32_t)((b7 * 2) / b4) : (int32_t)((b7 / b4) * 2);
+  x1 = (p >> 8) * (p >> 8);
+  x1 = (x1 * 3038) >> 16;
+  x2 = (-7357 * p) >> 16;
+  return p + ((x1 + x2 + 3791) >> 4);
+}
+
+// raw values that the compensation maps back onto the simulated weather (both are monotonic)
+static int32_t rawTemp() {
+  int32_t lo = 0, hi = 65535, b5;
+  int32_t want = (int32_t)lrintf(simWorld.tempC * 10.0f);
+  while (lo < hi) {
+    int32_t mid = (lo + hi) >> 1;
+    if (bmpTemp(mid, &b5) < want) lo = mid + 1;
+    else hi = mid;
+  }
+  return lo;
+}
+
+static int32_t rawPres(int oss) {
+  int32_t b5;
+  bmpTemp(rawTemp(), &b5);
+  int32_t lo = 0, hi = (1 << (16 + oss)) - 1;
+  int32_t want = (int32_t)lrintf(simWorld.pressurePa);
+  while (lo < hi) {
+    int32_t mid = (lo + hi) >> 1;
+    if (bmpPres(mid, b5, oss) < want) lo = mid + 1;
+    else hi = mid;
+  }
+  return lo;
+}
+
+/*****************************************************************************************************
+simI2cAnswers(): whether a device can be reached: not stuck (SimWorld::i2cFault) and not gone
+parameters: addr: uint8_t: I2C address
+returns: bool
+*****************************************************************************************************/
+bool simI2cAnswers(uint8_t addr) {
+  if (simWorld.i2cFault & 16) return false;
+  switch (addr) {
+    case BMP_ADDR:
+      return (simWorld.i2cFault & 1) == 0;
+    case AHT_ADDR:
+      return (simWorld.i2cFault & 2) == 0;
+    case BHA_ADDR:
+      return (simWorld.i2cFault & 4) == 0;
+    case BHB_ADDR:
+      return (simWorld.i2cFault & 8) == 0;
+  }
+  return false;
+}
+
+void TwoWire::beginTransmission(uint8_t addr) {
+  _addr = addr;
+  _txLen = 0;
+}
+
+size_t TwoWire::write(uint8_t b) {
+  if (_txLen >= (int)sizeof(_tx)) return 0;
+  _tx[_txLen++] = b;
+  return 1;
+}
+
+uint8_t TwoWire::endTransmission(bool) {
+  if (simWorld.i2cFault & 16) {  // stuck: the transaction runs into the timeout
+    delay(_timeoutMs);
+    return 5;
+  }
+  if (!simI2cAnswers(_addr)) return 2;
+  if (_addr == AHT_ADDR) {
+    if ((_txLen > 0) && (_tx[0] == 0xAC)) {
+      _ahtBusy = true;
+      _ahtStartUs = simNowUs;
+    }
+    return 0;
+  }
+  if (_addr == BMP_ADDR) {
+    if (_txLen > 0) _bmpReg = _tx[0];
+    if ((_txLen > 1) && (_bmpReg == 0xF4)) {  // start a conversion
+      _bmpCtrl = _tx[1];
+      _bmpStartUs = simNowUs;
+      _bmpOut = (_bmpCtrl == 0x2E) ? rawTemp() << 8 : rawPres(_bmpCtrl >> 6) << (8 - (_bmpCtrl >> 6));
+    }
+    return 0;
+  }
+  return 2;  // address NACK
+}
+
+uint8_t TwoWire::requestFrom(uint8_t addr, uint8_t len) {
+  _rxLen = 0;
+  _rxPos = 0;
+  if (simWorld.i2cFault & 16) delay(_timeoutMs);
+  if (!simI2cAnswers(addr)) return 0;
+  if (addr == AHT_ADDR) {
+    bool busy = _ahtBusy && (simNowUs - _ahtStartUs < AHT_CONV * 1000ULL);
+    uint32_t rh = (uint32_t)(simWorld.humidity / 100.0f * 1048576.0f);
+    uint32_t rt = (uint32_t)((simWorld.tempC + 50.0f) / 200.0f * 1048576.0f);
+    uint8_t d[6] = { (uint8_t)(busy ? 0x98 : 0x18), (uint8_t)(rh >> 12), (uint8_t)(rh >> 4),
+                     (uint8_t)(((rh & 0x0F) << 4) | ((rt >> 16) & 0x0F)), (uint8_t)(rt >> 8), (uint8_t)rt };
+    for (int i = 0; (i < len) && (i < 6); i++) _rx[_rxLen++] = d[i];
+    return _rxLen;
+  }
+  if (addr == BMP_ADDR) {
+    // conversion times: 4.5 ms for temperature, 1.5 + 3 << oss ms for pressure
+    uint64_t convUs = (_bmpCtrl == 0x2E) ? 4500 : 1500 + (3000ULL << (_bmpCtrl >> 6));
+    bool busy = simNowUs - _bmpStartUs < convUs;
+    for (int i = 0; i < len; i++) {
+      uint8_t reg = _bmpReg + i;
+      uint8_t v = 0;
+      if ((reg >= 0xAA) && (reg <= 0xBF)) {
+        static const uint16_t cal[11] = { (uint16_t)AC1, (uint16_t)AC2, (uint16_t)AC3, AC4, AC5, AC6,
+                                          (uint16_t)B1, (uint16_t)B2, (uint16_t)MB, (uint16_t)MC, (uint16_t)MD };
+        uint16_t w = cal[(reg - 0xAA) >> 1];
+        v = ((reg - 0xAA) & 1) ? (uint8_t)w : (uint8_t)(w >> 8);
+      } else if (reg == 0xF4) {
+        v = busy ? (_bmpCtrl | 0x20) : (_bmpCtrl & ~0x20);
+      } else if (reg == 0xF6) {
+        v = (uint8_t)(_bmpOut >> 16);
+      } else if (reg == 0xF7) {
+        v = (uint8_t)(_bmpOut >> 8);
+      } else if (reg == 0xF8) {
+        v = (uint8_t)_bmpOut;
+      }
+      _rx[_rxLen++] = v;
+    }
+    return _rxLen;
+  }
+  return 0;
+}
@@ -0,0 +1,23 @@
+#ifndef SIM_ZONES_H
+#define SIM_ZONES_H
+#include <stdint.h>
+
+#define SIM_MAX_ZONES 16
+
+struct SimZoneStat {
+  uint64_t calls;
+  uint64_t cpuNs;
+  uint64_t cpuMaxNs;
+  uint64_t virtUs;
+  uint64_t virtMaxUs;
+};
+
+extern SimZoneStat simZones[SIM_MAX_ZONES];
+extern uint64_t simLatenessMaxUs;  // how late the periodic (sampling) task started, worst case
+extern uint64_t simLatenessSumUs;
+extern uint64_t simPeriodicRuns;
+
+void simZoneSuspend();
+void simZoneResume();
+
+#endif
@@ -0,0 +1,17 @@
+// Compiles Roof4.ino as ordinary C++ for the host simulation.
+// The Arduino builder would generate the function prototypes; build/protos.h is made the same way by the Makefile.
+#include "hal/Arduino.h"
+#include "../Config.h"
+#include "../Komms.h"
+#include "../WInputs.h"
+#include "../Ring.h"
+#include "../Telemetry.h"
+#include "../RecordLog.h"
+#include "../Batcher.h"
+#include "../ZoneMetrics.h"
+#include "../MqttLink.h"
+#include "../Outbox.h"
+#include "../MemWatch.h"
+#include "../OtaServer.h"
+#include "protos.h"
+#include "../Roof4.ino"
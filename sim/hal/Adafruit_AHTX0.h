@@ -0,0 +1,18 @@
+#ifndef SIM_ADAFRUIT_AHTX0_H
+#define SIM_ADAFRUIT_AHTX0_H
+#include "Adafruit_Sensor.h"
+#include "Wire.h"
+
+// getEvent() blocks for the AHT20 conversion time, like the real library
+class Adafruit_AHTX0 {
+  public:
+    bool begin() { return simI2cAnswers(0x38); }
+    bool getEvent(sensors_event_t* humidity, sensors_event_t* temp) {
+      delay(80);
+      humidity->relative_humidity = simWorld.humidity;
+      temp->temperature = simWorld.tempC;
+      return true;
+    }
+};
+
+#endif
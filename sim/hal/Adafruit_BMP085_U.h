@@ -0,0 +1,21 @@
+#ifndef SIM_ADAFRUIT_BMP085_U_H
+#define SIM_ADAFRUIT_BMP085_U_H
+#include "Adafruit_Sensor.h"
+#include "Wire.h"
+
+// getPressure() blocks for a temperature plus an ultra-high-res pressure conversion
+class Adafruit_BMP085_Unified {
+  public:
+    Adafruit_BMP085_Unified(int32_t sensorID = -1) { (void)sensorID; }
+    bool begin() { return simI2cAnswers(0x77); }
+    void getTemperature(float* t) {
+      delay(5);
+      *t = simWorld.tempC;
+    }
+    void getPressure(float* p) {
+      delay(5 + 26);
+      *p = simWorld.pressurePa;
+    }
+};
+
+#endif
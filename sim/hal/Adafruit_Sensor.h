@@ -0,0 +1,11 @@
+#ifndef SIM_ADAFRUIT_SENSOR_H
+#define SIM_ADAFRUIT_SENSOR_H
+#include "Arduino.h"
+
+typedef struct {
+  float temperature;
+  float relative_humidity;
+  float pressure;
+} sensors_event_t;
+
+#endif
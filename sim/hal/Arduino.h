@@ -0,0 +1,120 @@
+#ifndef SIM_ARDUINO_H
+#define SIM_ARDUINO_H
+// Host stand-in for the ESP32 Arduino core: only what Roof4 uses
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <sys/types.h>
+#include <algorithm>
+#include "../SimHal.h"
+
+using std::max;
+using std::min;
+
+typedef uint8_t byte;
+
+#define IRAM_ATTR
+#define PROGMEM
+#define RTC_NOINIT_ATTR  // zero at sim start, like a cold boot: no warm start
+#define HIGH 1
+#define LOW 0
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+#define OUTPUT_OPEN_DRAIN 0x13
+#define RISING 0x01
+#define FALLING 0x02
+#define CHANGE 0x03
+#define digitalPinToInterrupt(p) (p)
+
+inline unsigned long millis() { return (unsigned long)(simNowUs / 1000); }
+inline unsigned long micros() { return (unsigned long)simNowUs; }
+inline int64_t esp_timer_get_time() { return (int64_t)simNowUs; }
+inline void delay(unsigned long ms) { simAdvanceUs((uint64_t)ms * 1000); }
+inline void delayMicroseconds(unsigned int us) { simAdvanceUs(us); }
+inline void yield() {}
+inline uint32_t esp_random() { return (uint32_t)rand(); }  // same sequence every run
+
+void pinMode(int pin, int mode);
+int digitalRead(int pin);
+void digitalWrite(int pin, int val);
+int analogRead(int pin);
+// Continuous ADC (esp32-hal-adc.h): a frame is ready each time the conversions it holds would have taken
+typedef struct {
+  uint8_t pin;
+  uint8_t channel;
+  int avg_read_raw;
+  int avg_read_mvolts;
+} adc_continuous_data_t;
+bool analogContinuous(const uint8_t pins[], size_t pins_count, uint32_t conversions_per_pin, uint32_t sampling_freq_hz,
+                      void (*userFunc)(void));
+bool analogContinuousRead(adc_continuous_data_t** buffer, uint32_t timeout_ms);
+bool analogContinuousStart();
+bool analogContinuousDeinit();
+inline void attachInterrupt(int pin, void (*fn)(), int mode) { simAttachIsr(pin, fn, mode); }
+inline void detachInterrupt(int pin) { simAttachIsr(pin, nullptr, 0); }
+[[noreturn]] inline void esp_restart() { simRestart(); }
+
+// FreeRTOS: tasks are not run as threads; Sim.cpp drives the sketch's task bodies on the virtual clock
+typedef void* TaskHandle_t;
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+#define pdPASS 1
+#define portMAX_DELAY 0xffffffffUL
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+// A task's handle is its stack size; the high-water mark is a fixed guess (the host cannot see it)
+inline BaseType_t xTaskCreatePinnedToCore(void (*)(void*), const char*, uint32_t stack, void*, int, TaskHandle_t* h, int) {
+  if (h) *h = (TaskHandle_t)(uintptr_t)stack;
+  return pdPASS;
+}
+inline uint32_t uxTaskGetStackHighWaterMark(TaskHandle_t h) { return (uint32_t)(uintptr_t)h / 2; }
+inline void vTaskDelete(TaskHandle_t) {}
+int simCoreId();
+inline BaseType_t xPortGetCoreID() { return simCoreId(); }
+inline TickType_t xTaskGetTickCount() { return (TickType_t)(simNowUs / 1000); }
+inline void vTaskDelay(TickType_t ticks) { simAdvanceUs((uint64_t)ticks * 1000); }
+inline void vTaskDelayUntil(TickType_t* prev, TickType_t inc) {
+  *prev += inc;
+  if (*prev > xTaskGetTickCount()) vTaskDelay(*prev - xTaskGetTickCount());
+}
+
+class String {
+  public:
+    String(const char* s = "") { snprintf(_buf, sizeof(_buf), "%s", s); }
+    const char* c_str() const { return _buf; }
+  private:
+    char _buf[80];  // a SHA-256 in hex fits
+};
+
+class HardwareSerial {
+  public:
+    void begin(unsigned long) {}
+    void print(const char* s) { if (simVerbose) fputs(s, stderr); }
+    void print(const String& s) { print(s.c_str()); }
+    void print(int v) { if (simVerbose) fprintf(stderr, "%d", v); }
+    void print(unsigned v) { if (simVerbose) fprintf(stderr, "%u", v); }
+    void print(long v) { if (simVerbose) fprintf(stderr, "%ld", v); }
+    void print(unsigned long v) { if (simVerbose) fprintf(stderr, "%lu", v); }
+    void print(double v) { if (simVerbose) fprintf(stderr, "%.2f", v); }
+    template <typename T> void println(T v) { print(v); print("\n"); }
+    void println() { print("\n"); }
+    template <typename... A> void printf(const char* fmt, A... args) {
+      if (simVerbose) fprintf(stderr, fmt, args...);
+    }
+};
+extern HardwareSerial Serial;
+
+// Heap figures come from the host allocator (see SimHal.cpp), so any allocation the sketch does not
+// give back shows up on ws/health as it would on the ESP32
+class EspClass {
+  public:
+    [[noreturn]] void restart() { simRestart(); }
+    uint32_t getFreeHeap();
+    uint32_t getMaxAllocHeap();
+    uint32_t getMinFreeHeap();
+};
+extern EspClass ESP;
+
+#endif
@@ -0,0 +1,11 @@
+#ifndef SIM_ESPMDNS_H
+#define SIM_ESPMDNS_H
+#include "Arduino.h"
+
+class MDNSResponder {
+  public:
+    bool begin(const char*) { return true; }
+};
+extern MDNSResponder MDNS;
+
+#endif
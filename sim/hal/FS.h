@@ -0,0 +1,33 @@
+#ifndef SIM_FS_H
+#define SIM_FS_H
+#include "Arduino.h"
+
+extern const char* simFsDir;
+
+class File {
+  public:
+    File(FILE* f = nullptr) : _f(f) {}
+    operator bool() const { return _f != nullptr; }
+    size_t read(uint8_t* buf, size_t len) { return _f ? fread(buf, 1, len, _f) : 0; }
+    size_t write(const uint8_t* buf, size_t len) { return _f ? fwrite(buf, 1, len, _f) : 0; }
+    bool seek(uint32_t pos) { return _f && (fseek(_f, pos, SEEK_SET) == 0); }
+    size_t size() {
+      if (!_f) return 0;
+      long here = ftell(_f);
+      fseek(_f, 0, SEEK_END);
+      long n = ftell(_f);
+      fseek(_f, here, SEEK_SET);
+      return (size_t)n;
+    }
+    void flush() {
+      if (_f) fflush(_f);
+    }
+    void close() {
+      if (_f) fclose(_f);
+      _f = nullptr;
+    }
+  private:
+    FILE* _f;
+};
+
+#endif
@@ -0,0 +1,25 @@
+#ifndef SIM_LITTLEFS_H
+#define SIM_LITTLEFS_H
+#include "FS.h"
+
+// Flash file system kept in a host directory (simFsDir)
+class LittleFSFS {
+  public:
+    bool begin(bool formatOnFail = false) {
+      (void)formatOnFail;
+      return true;
+    }
+    File open(const char* path, const char* mode) {
+      char full[256];
+      snprintf(full, sizeof(full), "%s%s", simFsDir, path);
+      return File(fopen(full, (strcmp(mode, "r+") == 0) ? "r+b" : (strcmp(mode, "w") == 0) ? "w+b" : "rb"));
+    }
+    bool remove(const char* path) {
+      char full[256];
+      snprintf(full, sizeof(full), "%s%s", simFsDir, path);
+      return ::remove(full) == 0;
+    }
+};
+extern LittleFSFS LittleFS;
+
+#endif
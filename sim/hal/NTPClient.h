@@ -0,0 +1,15 @@
+#ifndef SIM_NTPCLIENT_H
+#define SIM_NTPCLIENT_H
+#include "WiFiUdp.h"
+
+// Virtual clock zero is taken as midnight UTC
+class NTPClient {
+  public:
+    NTPClient(WiFiUDP&) {}
+    void begin() {}
+    void setTimeOffset(int) {}
+    bool update() { return true; }
+    int getHours() { return (int)((simNowUs / 3600000000ULL) % 24); }
+};
+
+#endif
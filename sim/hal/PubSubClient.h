@@ -0,0 +1,50 @@
+#ifndef SIM_PUBSUBCLIENT_H
+#define SIM_PUBSUBCLIENT_H
+#include "WiFiClient.h"
+
+#define MQTT_CALLBACK_SIGNATURE void (*callback)(char*, uint8_t*, unsigned int)
+
+// Publishes go to the sim output; a publish on ws/init is answered on ws/setup like the RPi does.
+// The retained ws/config payload (C events) comes on subscribing, and again each time it changes.
+// The connection drops, and publishes fail, while the trace has the broker or Wi-Fi down.
+class PubSubClient {
+  public:
+    PubSubClient(WiFiClient& client) : _client(client) {}
+    PubSubClient& setServer(const char*, uint16_t) { return *this; }
+    PubSubClient& setCallback(MQTT_CALLBACK_SIGNATURE) {
+      _callback = callback;
+      return *this;
+    }
+    bool connect(const char*) {
+      _connected = simWorld.brokerUp && simWorld.wifiUp;
+      if (!_connected) delay(_client.connTimeoutMs);  // waits out the TCP connect
+      return _connected;
+    }
+    void disconnect() { _connected = false; }
+    PubSubClient& setKeepAlive(uint16_t) { return *this; }
+    PubSubClient& setSocketTimeout(uint16_t) { return *this; }
+    bool setBufferSize(uint16_t size) {
+      _bufSize = size;
+      return true;
+    }
+    bool connected() { return _connected; }
+    int state() { return _connected ? 0 : -1; }
+    bool subscribe(const char* topic, uint8_t qos = 0);
+    bool unsubscribe(const char* topic);
+    bool publish(const char* topic, const char* payload, bool retained = false) {
+      return publish(topic, (const uint8_t*)payload, strlen(payload), retained);
+    }
+    bool publish(const char* topic, const uint8_t* payload, unsigned int len, bool retained = false);
+    bool loop();
+  private:
+    WiFiClient& _client;
+    void (*_callback)(char*, uint8_t*, unsigned int) = nullptr;
+    bool _connected = false;
+    uint16_t _bufSize = 256;  // library default: larger publishes fail
+    bool _setupSubscribed = false;
+    bool _replyPending = false;
+    bool _configSubscribed = false;
+    int _configSeen = 0;  // SimWorld::configSeq last delivered
+};
+
+#endif
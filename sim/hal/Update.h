@@ -0,0 +1,22 @@
+#ifndef SIM_UPDATE_H
+#define SIM_UPDATE_H
+#include "Arduino.h"
+
+#define UPDATE_SIZE_UNKNOWN 0xFFFFFFFF
+
+class UpdateClass {
+  public:
+    bool begin(size_t) { return _running = true; }
+    size_t write(uint8_t*, size_t len) { return len; }
+    bool end(bool = false) { return !(_running = false); }
+    void abort() { _running = false; }
+    bool isRunning() { return _running; }
+    bool hasError() { return false; }
+    const char* errorString() { return "No Error"; }
+    void printError(HardwareSerial&) {}
+  private:
+    bool _running = false;
+};
+extern UpdateClass Update;
+
+#endif
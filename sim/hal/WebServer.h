@@ -0,0 +1,46 @@
+#ifndef SIM_WEBSERVER_H
+#define SIM_WEBSERVER_H
+#include <functional>
+#include "WiFi.h"
+
+enum HTTPMethod { HTTP_GET, HTTP_POST };
+enum HTTPUploadStatus { UPLOAD_FILE_START, UPLOAD_FILE_WRITE, UPLOAD_FILE_END, UPLOAD_FILE_ABORTED };
+
+struct HTTPUpload {
+  HTTPUploadStatus status;
+  String filename;
+  size_t totalSize;
+  size_t currentSize;
+  uint8_t buf[1436];
+};
+
+// No HTTP clients connect in the simulation, except the uploads in the trace ('U' events):
+// handleClient() runs each one the way the real server does, the whole image inside one call
+class WebServer {
+  public:
+    typedef std::function<void(void)> THandlerFunction;
+    WebServer(int) {}
+    void on(const char*, HTTPMethod, THandlerFunction) {}
+    void on(const char*, HTTPMethod method, THandlerFunction fn, THandlerFunction upFn) {
+      if (method == HTTP_POST) {
+        _postFn = fn;
+        _upFn = upFn;
+      }
+    }
+    void begin() {}
+    void handleClient();  // SimHal.cpp
+    bool authenticate(const char*, const char*) { return true; }
+    void requestAuthentication() {}
+    String arg(const char* name) { return String(strcmp(name, "sha") == 0 ? _sha : ""); }
+    void sendHeader(const char*, const char*) {}
+    void send(int, const char*, const char*) {}
+    void send_P(int, const char*, const char*, size_t) {}
+    HTTPUpload& upload() { return _upload; }
+  private:
+    HTTPUpload _upload;
+    THandlerFunction _postFn;
+    THandlerFunction _upFn;
+    char _sha[65] = "";
+};
+
+#endif
@@ -0,0 +1,70 @@
+#ifndef SIM_WIFI_H
+#define SIM_WIFI_H
+#include "Arduino.h"
+
+#define WIFI_STA 1
+#define WL_CONNECTED 3
+#define WL_DISCONNECTED 6
+
+class IPAddress {
+  public:
+    IPAddress(uint8_t a = 0, uint8_t b = 0, uint8_t c = 0, uint8_t d = 0) : _b{a, b, c, d} {}
+    explicit IPAddress(uint32_t v) { memcpy(_b, &v, 4); }
+    operator uint32_t() const {
+      uint32_t v;
+      memcpy(&v, _b, 4);
+      return v;
+    }
+    uint8_t operator[](int i) const { return _b[i]; }
+    String toString() const {
+      char buf[16];
+      snprintf(buf, sizeof(buf), "%u.%u.%u.%u", _b[0], _b[1], _b[2], _b[3]);
+      return String(buf);
+    }
+  private:
+    uint8_t _b[4];
+};
+
+struct wifi_ap_record_t {
+  uint8_t ssid[33];
+};
+
+extern int simWifiScans;
+extern int simWifiDirect;
+
+// Always finds the shed network and connects first time; may drop later (trace "W" events).
+// simWifiScans and simWifiDirect count cold and warm (BSSID and channel given) connections.
+class WiFiClass {
+  public:
+    bool mode(int) { return true; }
+    bool disconnect() { return true; }
+    int scanNetworks() {
+      simWifiScans++;
+      return 1;
+    }
+    String SSID(int) { return String("BTB-NTCHT6"); }
+    void* getScanInfoByIndex(int i) { return (i == 0) ? &_scan : nullptr; }
+    void scanDelete() {}
+    int begin(const char*, const char*) { return WL_CONNECTED; }
+    int begin(const char*, const char*, int, const uint8_t*) {
+      simWifiDirect++;
+      return WL_CONNECTED;
+    }
+    bool config(IPAddress, IPAddress, IPAddress, IPAddress = IPAddress()) { return true; }
+    uint8_t* BSSID() { return _bssid; }
+    int channel() { return 6; }
+    IPAddress gatewayIP() { return IPAddress(192, 168, 1, 1); }
+    IPAddress subnetMask() { return IPAddress(255, 255, 255, 0); }
+    IPAddress dnsIP() { return IPAddress(192, 168, 1, 1); }
+    int waitForConnectResult() { return WL_CONNECTED; }
+    int status() { return simWorld.wifiUp ? WL_CONNECTED : WL_DISCONNECTED; }
+    bool reconnect() { return simWorld.wifiUp; }
+    IPAddress localIP() { return IPAddress(192, 168, 1, 50); }
+  private:
+    uint8_t _bssid[6] = { 0x02, 0x11, 0x22, 0x33, 0x44, 0x55 };
+    wifi_ap_record_t _scan = { "BTB-NTCHT6" };
+};
+
+extern WiFiClass WiFi;
+
+#endif
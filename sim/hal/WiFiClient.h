@@ -0,0 +1,12 @@
+#ifndef SIM_WIFICLIENT_H
+#define SIM_WIFICLIENT_H
+#include "WiFi.h"
+
+// Only the connect timeout matters: a connect to a broker that is down takes this long
+class WiFiClient {
+  public:
+    void setConnectionTimeout(uint32_t ms) { connTimeoutMs = ms; }
+    uint32_t connTimeoutMs = 3000;  // core default
+};
+
+#endif
@@ -0,0 +1,7 @@
+#ifndef SIM_WIFIUDP_H
+#define SIM_WIFIUDP_H
+#include "WiFi.h"
+
+class WiFiUDP {};
+
+#endif
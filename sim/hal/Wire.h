@@ -0,0 +1,29 @@
+#ifndef SIM_WIRE_H
+#define SIM_WIRE_H
+#include "Arduino.h"
+
+// Register-level I2C bus with the AHT20 and BMP180 behind it (see SimI2C.cpp)
+class TwoWire {
+  public:
+    bool begin() { return true; }
+    bool begin(int, int) { return true; }
+    void end() {}
+    void setTimeOut(uint16_t ms) { _timeoutMs = ms; }
+    void beginTransmission(uint8_t addr);
+    size_t write(uint8_t b);
+    uint8_t endTransmission(bool sendStop = true);
+    uint8_t requestFrom(uint8_t addr, uint8_t len);
+    int available() { return _rxLen - _rxPos; }
+    int read() { return (_rxPos < _rxLen) ? _rx[_rxPos++] : -1; }
+  private:
+    uint8_t _addr = 0;
+    uint16_t _timeoutMs = 50;
+    uint8_t _tx[32];
+    int _txLen = 0;
+    uint8_t _rx[32];
+    int _rxLen = 0;
+    int _rxPos = 0;
+};
+extern TwoWire Wire;
+
+#endif
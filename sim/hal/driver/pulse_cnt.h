@@ -0,0 +1,46 @@
+#ifndef SIM_PULSE_CNT_H
+#define SIM_PULSE_CNT_H
+#include "../Arduino.h"
+
+// The part of the ESP-IDF PCNT driver the sketch uses. Units count the sim's pin edges; the glitch
+// filter drops an edge that comes less than max_glitch_ns after the last one on that pin.
+#ifndef ESP_OK
+typedef int esp_err_t;
+#define ESP_OK 0
+#define ESP_FAIL -1
+#endif
+
+typedef struct SimPcntUnit* pcnt_unit_handle_t;
+typedef struct SimPcntUnit* pcnt_channel_handle_t;  // one channel per unit here
+
+typedef enum {
+  PCNT_CHANNEL_EDGE_ACTION_HOLD,
+  PCNT_CHANNEL_EDGE_ACTION_INCREASE,
+  PCNT_CHANNEL_EDGE_ACTION_DECREASE,
+} pcnt_channel_edge_action_t;
+
+typedef struct {
+  int low_limit;
+  int high_limit;
+} pcnt_unit_config_t;
+
+typedef struct {
+  uint32_t max_glitch_ns;
+} pcnt_glitch_filter_config_t;
+
+typedef struct {
+  int edge_gpio_num;
+  int level_gpio_num;
+} pcnt_chan_config_t;
+
+esp_err_t pcnt_new_unit(const pcnt_unit_config_t* config, pcnt_unit_handle_t* unit);
+esp_err_t pcnt_unit_set_glitch_filter(pcnt_unit_handle_t unit, const pcnt_glitch_filter_config_t* config);
+esp_err_t pcnt_new_channel(pcnt_unit_handle_t unit, const pcnt_chan_config_t* config, pcnt_channel_handle_t* chan);
+esp_err_t pcnt_channel_set_edge_action(pcnt_channel_handle_t chan, pcnt_channel_edge_action_t pos,
+                                       pcnt_channel_edge_action_t neg);
+esp_err_t pcnt_unit_enable(pcnt_unit_handle_t unit);
+esp_err_t pcnt_unit_clear_count(pcnt_unit_handle_t unit);
+esp_err_t pcnt_unit_start(pcnt_unit_handle_t unit);
+esp_err_t pcnt_unit_get_count(pcnt_unit_handle_t unit, int* value);
+
+#endif